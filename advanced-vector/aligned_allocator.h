@@ -0,0 +1,82 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <new>
+
+#include "vector.h"
+
+// Аллокатор, выравнивающий буферы по Alignment байт через перегрузки operator new/delete
+// с std::align_val_t. Alignment не меньше alignof(T), поэтому подходит и для типов с alignas.
+// Размер блока округляется вверх до кратного Alignment, и allocate_at_least сообщает
+// ёмкость с учётом округления: последняя кэш-линия буфера принадлежит только ему, а
+// векторизованные циклы могут использовать выровненные загрузки по всему буферу
+template <typename T, size_t Alignment = std::max(alignof(T), detail::CACHE_LINE_SIZE)>
+class AlignedAllocator {
+    static_assert(Alignment != 0 && (Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+    static_assert(Alignment >= alignof(T), "Alignment must not be weaker than alignof(T)");
+
+public:
+    using value_type = T;
+
+    static constexpr size_t ALIGNMENT = Alignment;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, std::max(Alignment, alignof(U))>;
+    };
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename U, size_t OtherAlignment>
+    AlignedAllocator(const AlignedAllocator<U, OtherAlignment>& /*other*/) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        return allocate_at_least(n).ptr;
+    }
+
+    AllocationResult<T> allocate_at_least(size_t n) {
+        if (n > MaxSize()) {
+            VECTOR_THROW(std::bad_array_new_length());
+        }
+        const size_t bytes = RoundUp(n * sizeof(T));
+        void* p = ::operator new(bytes, std::align_val_t{Alignment});
+        return {static_cast<T*>(p), bytes / sizeof(T)};
+    }
+
+    // Как allocate, но при нехватке памяти возвращает nullptr
+    T* try_allocate(size_t n) noexcept {
+        if (n > MaxSize()) {
+            return nullptr;
+        }
+        return static_cast<T*>(::operator new(RoundUp(n * sizeof(T)), std::align_val_t{Alignment}, std::nothrow));
+    }
+
+    void deallocate(T* p, size_t /*n*/) noexcept {
+        ::operator delete(static_cast<void*>(p), std::align_val_t{Alignment});
+    }
+
+    template <typename U, size_t OtherAlignment>
+    bool operator==(const AlignedAllocator<U, OtherAlignment>& /*other*/) const noexcept {
+        return Alignment == OtherAlignment;
+    }
+
+    template <typename U, size_t OtherAlignment>
+    bool operator!=(const AlignedAllocator<U, OtherAlignment>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    static constexpr size_t MaxSize() noexcept {
+        return (static_cast<size_t>(-1) - Alignment) / sizeof(T);
+    }
+
+    static constexpr size_t RoundUp(size_t bytes) noexcept {
+        return (bytes + Alignment - 1) & ~(Alignment - 1);
+    }
+};
+
+// Vector с буфером, выровненным по кэш-линии (или по Alignment)
+template <typename T, size_t Alignment = std::max(alignof(T), detail::CACHE_LINE_SIZE),
+          typename GrowthPolicy = DoublingGrowth>
+using AlignedVector = Vector<T, AlignedAllocator<T, Alignment>, GrowthPolicy>;
@@ -0,0 +1,449 @@
+#include "segmented_vector.h"
+#include "simd.h"
+#include "vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+// Сравнение Vector и std::vector. Результаты в формате JSON для отслеживания регрессий:
+//   ./vector_benchmark --benchmark_out=results.json --benchmark_out_format=json
+
+namespace {
+
+// Число выделений памяти контейнерами; позволяет убедиться, что операция не выделяет память
+size_t num_allocations = 0;
+
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() noexcept = default;
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& /*other*/) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        ++num_allocations;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>& /*other*/) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>& /*other*/) const noexcept {
+        return false;
+    }
+};
+
+template <typename T>
+using CountingVector = Vector<T, CountingAllocator<T>>;
+
+template <typename T>
+using CountingStdVector = std::vector<T, CountingAllocator<T>>;
+
+template <typename T>
+using CountingSegmentedVector = SegmentedVector<T, detail::DefaultChunkSize<T>(), CountingAllocator<T>>;
+
+// Тривиальный тип размером в кэш-линию
+struct Pod64 {
+    int64_t values[8];
+};
+
+// Тип, перемещение которого может бросать исключение: при реаллокации его приходится копировать
+struct ThrowingMove {
+    ThrowingMove() = default;
+
+    explicit ThrowingMove(size_t i)
+        : name(std::to_string(i)) {
+    }
+
+    ThrowingMove(const ThrowingMove&) = default;
+    ThrowingMove& operator=(const ThrowingMove&) = default;
+
+    ThrowingMove(ThrowingMove&& other) noexcept(false)
+        : name(std::move(other.name)) {
+    }
+
+    ThrowingMove& operator=(ThrowingMove&& other) noexcept(false) {
+        name = std::move(other.name);
+        return *this;
+    }
+
+    std::string name;
+};
+
+template <typename T>
+T MakeValue(size_t i) {
+    if constexpr (std::is_same_v<T, std::string>) {
+        // Короткая строка помещается в SSO-буфер и сама память не выделяет
+        return std::string(8, static_cast<char>('a' + i % 26));
+    } else if constexpr (std::is_same_v<T, Pod64>) {
+        Pod64 pod{};
+        pod.values[0] = static_cast<int64_t>(i);
+        return pod;
+    } else if constexpr (std::is_same_v<T, ThrowingMove>) {
+        return ThrowingMove(i);
+    } else {
+        return static_cast<T>(i);
+    }
+}
+
+size_t Weight(int value) {
+    return static_cast<size_t>(value);
+}
+
+size_t Weight(const std::string& value) {
+    return value.size();
+}
+
+size_t Weight(const Pod64& value) {
+    return static_cast<size_t>(value.values[0]);
+}
+
+size_t Weight(const ThrowingMove& value) {
+    return value.name.size();
+}
+
+// Единый интерфейс для сравнения Vector и std::vector
+template <typename T, typename Allocator>
+void ReserveIn(Vector<T, Allocator>& v, size_t capacity) {
+    v.Reserve(capacity);
+}
+
+template <typename T, typename Allocator>
+void ReserveIn(std::vector<T, Allocator>& v, size_t capacity) {
+    v.reserve(capacity);
+}
+
+template <typename T, size_t ChunkSize, typename Allocator>
+void ReserveIn(SegmentedVector<T, ChunkSize, Allocator>& v, size_t capacity) {
+    v.Reserve(capacity);
+}
+
+template <typename T, typename Allocator>
+void PushBackIn(Vector<T, Allocator>& v, const T& value) {
+    v.PushBack(value);
+}
+
+template <typename T, size_t ChunkSize, typename Allocator>
+void PushBackIn(SegmentedVector<T, ChunkSize, Allocator>& v, const T& value) {
+    v.PushBack(value);
+}
+
+template <typename T, typename Allocator>
+void PushBackIn(std::vector<T, Allocator>& v, const T& value) {
+    v.push_back(value);
+}
+
+template <typename T, typename Allocator, typename... Args>
+void EmplaceBackIn(Vector<T, Allocator>& v, Args&&... args) {
+    v.EmplaceBack(std::forward<Args>(args)...);
+}
+
+template <typename T, typename Allocator, typename... Args>
+void EmplaceBackIn(std::vector<T, Allocator>& v, Args&&... args) {
+    v.emplace_back(std::forward<Args>(args)...);
+}
+
+template <typename T, typename Allocator, typename... Args>
+void EmplaceIn(Vector<T, Allocator>& v, size_t index, Args&&... args) {
+    v.Emplace(v.begin() + index, std::forward<Args>(args)...);
+}
+
+template <typename T, typename Allocator, typename... Args>
+void EmplaceIn(std::vector<T, Allocator>& v, size_t index, Args&&... args) {
+    v.emplace(v.begin() + index, std::forward<Args>(args)...);
+}
+
+template <typename T, typename Allocator>
+void EraseIn(Vector<T, Allocator>& v, size_t index) {
+    v.Erase(v.begin() + index);
+}
+
+template <typename T, typename Allocator>
+void EraseIn(std::vector<T, Allocator>& v, size_t index) {
+    v.erase(v.begin() + index);
+}
+
+template <typename VectorType>
+VectorType MakeFilled(size_t size) {
+    using T = typename VectorType::value_type;
+    VectorType v;
+    ReserveIn(v, size);
+    for (size_t i = 0; i < size; ++i) {
+        PushBackIn(v, MakeValue<T>(i));
+    }
+    return v;
+}
+
+// Размер вектора задаётся в байтах, чтобы сравнивать типы разного размера на одних уровнях
+// иерархии памяти: от L1 до объёма, заведомо превышающего последний уровень кэша
+template <typename VectorType>
+size_t ElementCount(const benchmark::State& state) {
+    return std::max<size_t>(static_cast<size_t>(state.range(0)) / sizeof(typename VectorType::value_type), 1);
+}
+
+void MemoryHierarchySizes(benchmark::internal::Benchmark* benchmark) {
+    for (int64_t bytes : {16 << 10, 256 << 10, 4 << 20, 64 << 20}) {
+        benchmark->Arg(bytes);
+    }
+}
+
+// Небольшие размеры для операций с квадратичной сложностью
+void SmallSizes(benchmark::internal::Benchmark* benchmark) {
+    for (int64_t bytes : {4 << 10, 32 << 10, 256 << 10}) {
+        benchmark->Arg(bytes);
+    }
+}
+
+template <typename VectorType>
+void SetProcessed(benchmark::State& state, size_t elements_per_iteration) {
+    const auto elements = static_cast<int64_t>(elements_per_iteration) * state.iterations();
+    state.SetItemsProcessed(elements);
+    state.SetBytesProcessed(elements * static_cast<int64_t>(sizeof(typename VectorType::value_type)));
+}
+
+// Заполнение пустого вектора с реаллокациями по мере роста
+template <typename VectorType>
+void BM_PushBack(benchmark::State& state) {
+    using T = typename VectorType::value_type;
+    const size_t size = ElementCount<VectorType>(state);
+    const T value = MakeValue<T>(size);
+    for (auto _ : state) {
+        VectorType v;
+        for (size_t i = 0; i < size; ++i) {
+            PushBackIn(v, value);
+        }
+        benchmark::DoNotOptimize(v.begin());
+    }
+    SetProcessed<VectorType>(state, size);
+}
+
+template <typename VectorType>
+void BM_EmplaceBack(benchmark::State& state) {
+    using T = typename VectorType::value_type;
+    const size_t size = ElementCount<VectorType>(state);
+    for (auto _ : state) {
+        VectorType v;
+        for (size_t i = 0; i < size; ++i) {
+            EmplaceBackIn(v, MakeValue<T>(i));
+        }
+        benchmark::DoNotOptimize(v.begin());
+    }
+    SetProcessed<VectorType>(state, size);
+}
+
+// Заполнение вектора с заранее зарезервированной ёмкостью
+template <typename VectorType>
+void BM_PushBackReserved(benchmark::State& state) {
+    using T = typename VectorType::value_type;
+    const size_t size = ElementCount<VectorType>(state);
+    const T value = MakeValue<T>(size);
+    for (auto _ : state) {
+        VectorType v;
+        ReserveIn(v, size);
+        for (size_t i = 0; i < size; ++i) {
+            PushBackIn(v, value);
+        }
+        benchmark::DoNotOptimize(v.begin());
+    }
+    SetProcessed<VectorType>(state, size);
+}
+
+// Перенос заполненного вектора в буфер вдвое большей ёмкости
+template <typename VectorType>
+void BM_Regrowth(benchmark::State& state) {
+    const size_t size = ElementCount<VectorType>(state);
+    for (auto _ : state) {
+        state.PauseTiming();
+        VectorType v = MakeFilled<VectorType>(size);
+        state.ResumeTiming();
+
+        ReserveIn(v, size * 2);
+        benchmark::DoNotOptimize(v.begin());
+
+        state.PauseTiming();
+        v = VectorType();
+        state.ResumeTiming();
+    }
+    SetProcessed<VectorType>(state, size);
+}
+
+// Вставка в середину вектора, ёмкости которого достаточно для всех вставок
+template <typename VectorType>
+void BM_EmplaceMiddleReserved(benchmark::State& state) {
+    using T = typename VectorType::value_type;
+    const size_t size = ElementCount<VectorType>(state);
+    const T value = MakeValue<T>(size);
+    size_t allocations = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        VectorType v = MakeFilled<VectorType>(size);
+        ReserveIn(v, size * 2);
+        const size_t allocations_before = num_allocations;
+        state.ResumeTiming();
+
+        for (size_t i = 0; i < size; ++i) {
+            EmplaceIn(v, size / 2, value);
+        }
+        benchmark::DoNotOptimize(v.begin());
+
+        state.PauseTiming();
+        allocations += num_allocations - allocations_before;
+        v = VectorType();
+        state.ResumeTiming();
+    }
+    SetProcessed<VectorType>(state, size);
+    state.counters["allocs_per_op"] = benchmark::Counter(static_cast<double>(allocations) / static_cast<double>(size),
+                                                         benchmark::Counter::kAvgIterations);
+}
+
+// Удаление из середины вектора
+template <typename VectorType>
+void BM_EraseMiddle(benchmark::State& state) {
+    const size_t size = ElementCount<VectorType>(state);
+    for (auto _ : state) {
+        state.PauseTiming();
+        VectorType v = MakeFilled<VectorType>(size);
+        state.ResumeTiming();
+
+        for (size_t i = 0; i < size / 2; ++i) {
+            EraseIn(v, size / 4);
+        }
+        benchmark::DoNotOptimize(v.begin());
+
+        state.PauseTiming();
+        v = VectorType();
+        state.ResumeTiming();
+    }
+    SetProcessed<VectorType>(state, size / 2);
+}
+
+// Присваивание копированием в вектор той же ёмкости
+template <typename VectorType>
+void BM_CopyAssign(benchmark::State& state) {
+    const size_t size = ElementCount<VectorType>(state);
+    const VectorType source = MakeFilled<VectorType>(size);
+    VectorType destination = MakeFilled<VectorType>(size);
+    for (auto _ : state) {
+        destination = source;
+        benchmark::DoNotOptimize(destination.begin());
+        benchmark::ClobberMemory();
+    }
+    SetProcessed<VectorType>(state, size);
+}
+
+// Присваивание копированием в пустой вектор: одно выделение памяти и копирование элементов
+template <typename VectorType>
+void BM_CopyAssignEmpty(benchmark::State& state) {
+    const size_t size = ElementCount<VectorType>(state);
+    const VectorType source = MakeFilled<VectorType>(size);
+    for (auto _ : state) {
+        VectorType destination;
+        destination = source;
+        benchmark::DoNotOptimize(destination.begin());
+        benchmark::ClobberMemory();
+    }
+    SetProcessed<VectorType>(state, size);
+}
+
+// Последовательный проход по элементам
+template <typename VectorType>
+void BM_Iterate(benchmark::State& state) {
+    const size_t size = ElementCount<VectorType>(state);
+    const VectorType v = MakeFilled<VectorType>(size);
+    for (auto _ : state) {
+        size_t sum = 0;
+        for (const auto& value : v) {
+            sum += Weight(value);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    SetProcessed<VectorType>(state, size);
+}
+
+// Сумма элементов последовательным циклом и simd::Sum с набором инструкций из второго аргумента
+template <typename T>
+void BM_LoopSum(benchmark::State& state) {
+    const size_t size = ElementCount<Vector<T>>(state);
+    const Vector<T> v(size);
+    for (auto _ : state) {
+        T sum = 0;
+        for (T value : v) {
+            sum += value;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    SetProcessed<Vector<T>>(state, size);
+}
+
+template <typename T>
+void BM_SimdSum(benchmark::State& state) {
+    const auto isa = static_cast<simd::Isa>(state.range(1));
+    if (!simd::IsSupported(isa)) {
+        state.SkipWithError("Instruction set is not supported");
+        return;
+    }
+    const simd::Isa previous = simd::SetActiveIsa(isa);
+    const size_t size = ElementCount<Vector<T>>(state);
+    const Vector<T> v(size);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(simd::Sum(v));
+    }
+    SetProcessed<Vector<T>>(state, size);
+    simd::SetActiveIsa(previous);
+}
+
+void SimdSizes(benchmark::internal::Benchmark* benchmark) {
+    for (simd::Isa isa : {simd::Isa::Scalar, simd::Isa::Sse42, simd::Isa::Avx2, simd::Isa::Avx512, simd::Isa::Neon}) {
+        for (int64_t bytes : {16 << 10, 4 << 20}) {
+            benchmark->Args({bytes, static_cast<int64_t>(isa)});
+        }
+    }
+}
+
+}  // namespace
+
+#define VECTOR_BENCHMARK(name, T, sizes)                                  \
+    BENCHMARK_TEMPLATE(name, CountingVector<T>)->Apply(sizes);            \
+    BENCHMARK_TEMPLATE(name, CountingStdVector<T>)->Apply(sizes)
+
+#define VECTOR_BENCHMARK_ALL_TYPES(name, sizes)          \
+    VECTOR_BENCHMARK(name, int, sizes);                  \
+    VECTOR_BENCHMARK(name, std::string, sizes);          \
+    VECTOR_BENCHMARK(name, Pod64, sizes);                \
+    VECTOR_BENCHMARK(name, ThrowingMove, sizes)
+
+VECTOR_BENCHMARK_ALL_TYPES(BM_PushBack, MemoryHierarchySizes);
+VECTOR_BENCHMARK_ALL_TYPES(BM_EmplaceBack, MemoryHierarchySizes);
+VECTOR_BENCHMARK_ALL_TYPES(BM_PushBackReserved, MemoryHierarchySizes);
+VECTOR_BENCHMARK_ALL_TYPES(BM_Regrowth, MemoryHierarchySizes);
+VECTOR_BENCHMARK_ALL_TYPES(BM_EmplaceMiddleReserved, SmallSizes);
+VECTOR_BENCHMARK_ALL_TYPES(BM_EraseMiddle, SmallSizes);
+VECTOR_BENCHMARK_ALL_TYPES(BM_CopyAssign, MemoryHierarchySizes);
+VECTOR_BENCHMARK_ALL_TYPES(BM_CopyAssignEmpty, MemoryHierarchySizes);
+VECTOR_BENCHMARK_ALL_TYPES(BM_Iterate, MemoryHierarchySizes);
+
+// Рост SegmentedVector не переносит элементы
+BENCHMARK_TEMPLATE(BM_PushBack, CountingSegmentedVector<std::string>)->Apply(MemoryHierarchySizes);
+BENCHMARK_TEMPLATE(BM_PushBack, CountingSegmentedVector<Pod64>)->Apply(MemoryHierarchySizes);
+BENCHMARK_TEMPLATE(BM_Iterate, CountingSegmentedVector<int>)->Apply(MemoryHierarchySizes);
+
+BENCHMARK_TEMPLATE(BM_LoopSum, float)->Apply(MemoryHierarchySizes);
+BENCHMARK_TEMPLATE(BM_LoopSum, int8_t)->Apply(MemoryHierarchySizes);
+BENCHMARK_TEMPLATE(BM_SimdSum, float)->Apply(SimdSizes);
+BENCHMARK_TEMPLATE(BM_SimdSum, int8_t)->Apply(SimdSizes);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,247 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+#include "vector.h"
+
+namespace detail {
+
+// Номер старшего единичного бита value != 0, то есть floor(log2(value))
+inline size_t FloorLog2(size_t value) noexcept {
+    assert(value != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    static_assert(sizeof(size_t) <= sizeof(unsigned long long), "size_t is wider than unsigned long long");
+    return sizeof(unsigned long long) * 8 - 1 - static_cast<size_t>(__builtin_clzll(value));
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index = 0;
+    _BitScanReverse64(&index, value);
+    return index;
+#elif defined(_MSC_VER)
+    unsigned long index = 0;
+    _BitScanReverse(&index, value);
+    return index;
+#else
+    size_t index = 0;
+    while (value >>= 1) {
+        ++index;
+    }
+    return index;
+#endif
+}
+
+}  // namespace detail
+
+// Вектор, в конец которого могут одновременно добавлять элементы несколько потоков.
+// Элементы хранятся в сегментах (RawMemory), каждый следующий вдвое больше предыдущего, поэтому
+// рост не перемещает элементы и не делает недействительными ссылки на них. EmplaceBack резервирует
+// номер элемента атомарным fetch_add и публикует элемент после конструирования. Size() возвращает
+// длину префикса опубликованных элементов: все элементы с меньшими номерами доступны для чтения.
+// Чтение опубликованных элементов (operator[], Size) не использует блокировок и не ждёт писателей
+template <typename T, typename Allocator = std::allocator<T>>
+class ConcurrentVector {
+    using Ops = detail::ElementOps<T, Allocator>;
+
+    // Размер первого сегмента — 2^FIRST_SEGMENT_BITS элементов
+    static constexpr size_t FIRST_SEGMENT_BITS = 5;
+    static constexpr size_t MAX_SEGMENTS = sizeof(size_t) * 8 - FIRST_SEGMENT_BITS;
+
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+
+    ConcurrentVector() = default;
+
+    explicit ConcurrentVector(const Allocator& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    ConcurrentVector(const ConcurrentVector&) = delete;
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+    // Вызывается, когда другие потоки уже не обращаются к вектору
+    ~ConcurrentVector() {
+        for (size_t k = 0; k < MAX_SEGMENTS; ++k) {
+            Segment* segment = segments_[k].load(std::memory_order_acquire);
+            if (segment == nullptr) {
+                continue;
+            }
+            for (size_t i = 0; i < SegmentSize(k); ++i) {
+                if (segment->ready[i].load(std::memory_order_relaxed)) {
+                    Ops::Destroy(segment->memory.GetAllocator(), segment->memory + i);
+                }
+            }
+            delete segment;
+        }
+    }
+
+    // Выделяет сегменты для первых capacity элементов, после чего добавление элементов
+    // до этой ёмкости не выделяет память. Может вызываться одновременно с EmplaceBack
+    void Reserve(size_t capacity) {
+        if (capacity == 0) {
+            return;
+        }
+        const size_t last_segment = SegmentOf(capacity - 1);
+        for (size_t k = 0; k <= last_segment; ++k) {
+            GetSegment(k);
+        }
+    }
+
+    // Если конструктор T выбрасывает исключение, вектор не изменяется. Если не удаётся выделить
+    // память под новый сегмент, а номер элемента уже зарезервирован и за ним другими потоками,
+    // вызывается std::terminate: пропуск в последовательности сделал бы невозможной публикацию
+    // следующих элементов. Reserve заранее выделяет память и исключает такую ситуацию
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if constexpr (std::is_nothrow_constructible_v<T, Args&&...>) {
+            return EmplaceReserved(std::forward<Args>(args)...);
+        } else {
+            // Исключение из конструктора возможно только до резервирования номера
+            static_assert(std::is_nothrow_move_constructible_v<T>,
+                          "ConcurrentVector requires nothrow construction or nothrow move");
+            T value(std::forward<Args>(args)...);
+            return EmplaceReserved(std::move(value));
+        }
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Число опубликованных элементов
+    size_t Size() const noexcept {
+        return published_.load(std::memory_order_acquire);
+    }
+
+    // Суммарный размер выделенных сегментов. Сегмент выделяет поток, первым занявший номер в нём,
+    // поэтому следующий сегмент может появиться раньше предыдущего, и просматриваются все
+    size_t Capacity() const noexcept {
+        size_t capacity = 0;
+        for (size_t k = 0; k < MAX_SEGMENTS; ++k) {
+            if (segments_[k].load(std::memory_order_acquire) != nullptr) {
+                capacity += SegmentSize(k);
+            }
+        }
+        return capacity;
+    }
+
+    // Элемент должен быть опубликован: index < Size()
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<ConcurrentVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < Size());
+        return *Slot(index);
+    }
+
+private:
+    struct Segment {
+        Segment(size_t size, const Allocator& alloc)
+            : memory(size, alloc)
+            , ready(new std::atomic<bool>[size]()) {
+        }
+
+        RawMemory<T, Allocator> memory;
+        // Элемент сконструирован; флаги позволяют публиковать элементы в порядке номеров
+        std::unique_ptr<std::atomic<bool>[]> ready;
+    };
+
+    Allocator alloc_;
+    std::atomic<Segment*> segments_[MAX_SEGMENTS] = {};
+    // Число зарезервированных номеров
+    std::atomic<size_t> reserved_{0};
+    // Длина префикса сконструированных элементов
+    std::atomic<size_t> published_{0};
+
+    static size_t SegmentOf(size_t index) noexcept {
+        const size_t shifted = index + (size_t{1} << FIRST_SEGMENT_BITS);
+        return detail::FloorLog2(shifted) - FIRST_SEGMENT_BITS;
+    }
+
+    static size_t SegmentSize(size_t segment) noexcept {
+        return size_t{1} << (segment + FIRST_SEGMENT_BITS);
+    }
+
+    // Номер первого элемента сегмента
+    static size_t SegmentStart(size_t segment) noexcept {
+        return SegmentSize(segment) - (size_t{1} << FIRST_SEGMENT_BITS);
+    }
+
+    // Возвращает сегмент, выделяя его, если его ещё нет. Если сегмент одновременно выделяют
+    // несколько потоков, устанавливается один из них, а остальные освобождаются
+    Segment& GetSegment(size_t k) {
+        Segment* segment = segments_[k].load(std::memory_order_acquire);
+        if (segment != nullptr) {
+            return *segment;
+        }
+
+        auto new_segment = std::make_unique<Segment>(SegmentSize(k), alloc_);
+        if (segments_[k].compare_exchange_strong(segment, new_segment.get(), std::memory_order_acq_rel,
+                                                 std::memory_order_acquire)) {
+            return *new_segment.release();
+        }
+        return *segment;
+    }
+
+    T* Slot(size_t index) const noexcept {
+        const size_t k = SegmentOf(index);
+        return segments_[k].load(std::memory_order_acquire)->memory + (index - SegmentStart(k));
+    }
+
+    template <typename... Args>
+    T& EmplaceReserved(Args&&... args) {
+        const size_t index = reserved_.fetch_add(1);
+        const size_t k = SegmentOf(index);
+
+        Segment* segment = nullptr;
+        VECTOR_TRY {
+            segment = &GetSegment(k);
+        } VECTOR_CATCH_ALL {
+            // Номер можно вернуть, только если после него никто не резервировал
+            size_t expected = index + 1;
+            if (!reserved_.compare_exchange_strong(expected, index, std::memory_order_relaxed)) {
+                std::terminate();
+            }
+            VECTOR_RETHROW();
+        }
+
+        const size_t offset = index - SegmentStart(k);
+        T* slot = segment->memory + offset;
+        Ops::Construct(segment->memory.GetAllocator(), slot, std::forward<Args>(args)...);
+        segment->ready[offset].store(true);
+        Publish();
+        return *slot;
+    }
+
+    // Продвигает границу опубликованных элементов, пока за ней идут сконструированные элементы.
+    // Поток, сконструировавший элемент раньше предшественников, не ждёт их: элемент опубликует
+    // поток предшественника. Флаги, reserved_ и published_ используют последовательную согласованность:
+    // из двух потоков, одновременно выставивших флаги соседних элементов, хотя бы один увидит флаг другого
+    void Publish() noexcept {
+        size_t published = published_.load();
+        while (published < reserved_.load()) {
+            const size_t k = SegmentOf(published);
+            Segment* segment = segments_[k].load();
+            if (segment == nullptr || !segment->ready[published - SegmentStart(k)].load()) {
+                return;
+            }
+            if (published_.compare_exchange_weak(published, published + 1)) {
+                ++published;
+            }
+        }
+    }
+};
@@ -0,0 +1,321 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "index_iterator.h"
+#include "vector.h"
+
+// Вектор с пошаговой реаллокацией для кода, чувствительного к задержкам. При росте выделяется новый
+// буфер, но старые элементы переносятся в него не сразу, а по MigrationStep за каждую следующую
+// операцию изменения. Пока перенос не завершён, элемент с номером i находится в старом буфере,
+// если migrated_ <= i < old_size_, и в новом в остальных случаях, поэтому чтение по номеру работает
+// всегда, а непрерывный буфер (Data) становится доступен после FinishMigration.
+// Итераторы переходят по номерам и не требуют завершения переноса.
+// При росте вдвое и MigrationStep >= 1 перенос успевает завершиться до следующей реаллокации
+template <typename T, size_t MigrationStep = 16, typename Allocator = std::allocator<T>,
+          typename GrowthPolicy = DoublingGrowth>
+class IncrementalVector {
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using Ops = detail::ElementOps<T, Allocator>;
+
+    static_assert(MigrationStep > 0, "Migration must make progress");
+    // Перенос выполняется внутри других операций и не должен выбрасывать исключений
+    static_assert(Ops::CAN_SHIFT, "Elements must be trivially relocatable or nothrow move constructible");
+
+public:
+    using value_type = T;
+    using iterator = detail::IndexIterator<IncrementalVector, false>;
+    using const_iterator = detail::IndexIterator<IncrementalVector, true>;
+    using allocator_type = Allocator;
+
+    IncrementalVector() = default;
+
+    explicit IncrementalVector(const Allocator& alloc) noexcept
+        : data_(alloc)
+        , old_(alloc) {
+    }
+
+    IncrementalVector(const IncrementalVector& other)
+        : IncrementalVector(other, AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator())) {
+    }
+
+    IncrementalVector(const IncrementalVector& other, const Allocator& alloc)
+        : data_(other.size_, alloc)
+        , old_(alloc)  //
+    {
+        ConstructFrom<const T&>(other);
+    }
+
+    IncrementalVector(IncrementalVector&& other) noexcept
+        : data_(std::move(other.data_))
+        , old_(std::move(other.old_))
+        , size_(std::exchange(other.size_, 0))
+        , old_size_(std::exchange(other.old_size_, 0))
+        , migrated_(std::exchange(other.migrated_, 0)) {
+    }
+
+    // Если аллокаторы не равны, буферы other не могут перейти во владение *this,
+    // поэтому элементы перемещаются поштучно в новую память
+    IncrementalVector(IncrementalVector&& other, const Allocator& alloc)
+        : data_(alloc)
+        , old_(alloc) {
+        if (alloc == other.data_.GetAllocator()) {
+            TakeStorage(other);
+        } else {
+            RawMemory<T, Allocator> new_data(other.size_, alloc);
+            data_.Swap(new_data);
+            ConstructFrom<T&&>(other);
+        }
+    }
+
+    IncrementalVector& operator=(const IncrementalVector& rhs) {
+        if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                if (data_.GetAllocator() != rhs.data_.GetAllocator()) {
+                    // Элементы и память должны быть освобождены прежним аллокатором
+                    Clear();
+                }
+                data_.AssignAllocator(rhs.data_.GetAllocator());
+                old_.AssignAllocator(rhs.data_.GetAllocator());
+            }
+            // Копия строится аллокатором *this, поэтому обмен передаёт буферы между равными аллокаторами
+            IncrementalVector rhs_copy(rhs, data_.GetAllocator());
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    IncrementalVector& operator=(IncrementalVector&& rhs) noexcept(
+        AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value) {
+        if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value
+                          || AllocTraits::is_always_equal::value) {
+                MoveAssignStorage(rhs);
+            } else if (data_.GetAllocator() == rhs.data_.GetAllocator()) {
+                MoveAssignStorage(rhs);
+            } else {
+                IncrementalVector rhs_moved(std::move(rhs), data_.GetAllocator());
+                Swap(rhs_moved);
+            }
+        }
+        return *this;
+    }
+
+    ~IncrementalVector() {
+        Clear();
+    }
+
+    // Если аллокаторы не распространяются при обмене, они должны быть равны
+    void Swap(IncrementalVector& other) noexcept {
+        if constexpr (!AllocTraits::propagate_on_container_swap::value) {
+            assert(data_.GetAllocator() == other.data_.GetAllocator());
+        }
+        data_.Swap(other.data_);
+        old_.Swap(other.old_);
+        std::swap(size_, other.size_);
+        std::swap(old_size_, other.old_size_);
+        std::swap(migrated_, other.migrated_);
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+    // Элементы ещё не перенесены в новый буфер полностью
+    bool IsMigrating() const noexcept {
+        return old_.GetAddress() != nullptr;
+    }
+
+    // Переносит оставшиеся элементы и освобождает старый буфер
+    void FinishMigration() noexcept {
+        if (IsMigrating()) {
+            Migrate(old_size_ - migrated_);
+        }
+    }
+
+    // Выделяет буфер ёмкостью new_capacity; элементы переносятся в него постепенно
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > Capacity()) {
+            RawMemory<T, Allocator> new_data(new_capacity, data_.GetAllocator());
+            StartMigration(new_data);
+        }
+    }
+
+    void Clear() noexcept {
+        if (IsMigrating()) {
+            Ops::DestroyN(data_.GetAllocator(), data_.GetAddress(), migrated_);
+            Ops::DestroyN(old_.GetAllocator(), old_ + migrated_, old_size_ - migrated_);
+            Ops::DestroyN(data_.GetAllocator(), data_ + old_size_, size_ - old_size_);
+            ReleaseOld();
+        } else {
+            Ops::DestroyN(data_.GetAllocator(), data_.GetAddress(), size_);
+        }
+        size_ = 0;
+    }
+
+    // Время операции ограничено конструированием элемента и переносом MigrationStep элементов,
+    // если только не потребовался рост до завершения предыдущего переноса
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            RawMemory<T, Allocator> new_data(GrowthPolicy::NextCapacity(Capacity(), size_ + 1, sizeof(T)),
+                                             data_.GetAllocator());
+            // Аргументы могут ссылаться на элементы, поэтому новый элемент конструируется до переноса
+            Ops::Construct(new_data.GetAllocator(), new_data + size_, std::forward<Args>(args)...);
+            StartMigration(new_data);
+        } else {
+            Ops::Construct(data_.GetAllocator(), data_ + size_, std::forward<Args>(args)...);
+        }
+        ++size_;
+        Migrate(MigrationStep);
+        return data_[size_ - 1];
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() noexcept {
+        assert(size_ != 0);
+        --size_;
+        if (size_ < old_size_) {
+            // Новая часть пуста, последний элемент ещё в старом буфере
+            Ops::Destroy(old_.GetAllocator(), old_ + size_);
+            old_size_ = size_;
+        } else {
+            Ops::Destroy(data_.GetAllocator(), data_ + size_);
+        }
+        Migrate(MigrationStep);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return data_.Capacity();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<IncrementalVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        if (index >= migrated_ && index < old_size_) {
+            return old_[index];
+        }
+        return data_[index];
+    }
+
+    // Непрерывный буфер с элементами; завершает перенос
+    T* Data() noexcept {
+        FinishMigration();
+        return data_.GetAddress();
+    }
+
+    // Итераторы обращаются к элементам по номеру через operator[], поэтому обход не завершает
+    // перенос и остаётся корректным во время него
+    iterator begin() noexcept {
+        return iterator(this, 0);
+    }
+
+    iterator end() noexcept {
+        return iterator(this, size_);
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator cend() const noexcept {
+        return const_iterator(this, size_);
+    }
+
+private:
+
+    RawMemory<T, Allocator> data_;
+    // Буфер, из которого переносятся элементы [migrated_, old_size_)
+    RawMemory<T, Allocator> old_;
+    size_t size_ = 0;
+    size_t old_size_ = 0;
+    size_t migrated_ = 0;
+
+    // Конструирует в пустом буфере data_ элементы other, передавая их конструктору как Value:
+    // const T& для копирования, T&& для перемещения
+    template <typename Value, typename Other>
+    void ConstructFrom(Other& other) {
+        size_t i = 0;
+        VECTOR_TRY {
+            for (; i < other.size_; ++i) {
+                Ops::Construct(data_.GetAllocator(), data_ + i, static_cast<Value>(other[i]));
+            }
+        } VECTOR_CATCH_ALL {
+            Ops::DestroyN(data_.GetAllocator(), data_.GetAddress(), i);
+            VECTOR_RETHROW();
+        }
+        size_ = other.size_;
+    }
+
+    // Забирает буферы other; аллокаторы *this и other равны либо распространяются при перемещении
+    void TakeStorage(IncrementalVector& other) noexcept {
+        data_ = std::move(other.data_);
+        old_ = std::move(other.old_);
+        size_ = std::exchange(other.size_, 0);
+        old_size_ = std::exchange(other.old_size_, 0);
+        migrated_ = std::exchange(other.migrated_, 0);
+    }
+
+    // Вызывается, когда буферы rhs могут перейти во владение *this
+    void MoveAssignStorage(IncrementalVector& rhs) noexcept {
+        Clear();
+        TakeStorage(rhs);
+    }
+
+    // Делает new_data текущим буфером; элементы [0, size_) переносятся в него постепенно
+    void StartMigration(RawMemory<T, Allocator>& new_data) noexcept {
+        FinishMigration();
+        old_.Swap(data_);
+        data_.Swap(new_data);
+        old_size_ = size_;
+        migrated_ = 0;
+        if (old_size_ == 0) {
+            ReleaseOld();
+        }
+    }
+
+    void Migrate(size_t count) noexcept {
+        if (!IsMigrating()) {
+            return;
+        }
+        count = std::min(count, old_size_ - migrated_);
+        Ops::TransferN(old_.GetAllocator(), old_ + migrated_, count, data_ + migrated_);
+        migrated_ += count;
+        if (migrated_ == old_size_) {
+            ReleaseOld();
+        }
+    }
+
+    void ReleaseOld() noexcept {
+        RawMemory<T, Allocator> old(old_.GetAllocator());
+        old_.Swap(old);
+        old_size_ = 0;
+        migrated_ = 0;
+    }
+};
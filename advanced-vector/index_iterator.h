@@ -0,0 +1,158 @@
+#pragma once
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+// Указатель для operator-> итератора, который возвращает ссылку-прокси по значению
+template <typename Reference>
+class ArrowProxy {
+public:
+    explicit ArrowProxy(Reference ref) noexcept
+        : ref_(std::move(ref)) {
+    }
+
+    Reference* operator->() noexcept {
+        return &ref_;
+    }
+
+private:
+    Reference ref_;
+};
+
+// Итератор произвольного доступа, который хранит контейнер и номер элемента и разыменовывается
+// через (*owner)[index]. Адресов элементов он не запоминает, поэтому остаётся действительным,
+// когда контейнер растёт или переносит элементы между буферами. Owner — неконстантный тип
+// контейнера, IsConst выбирает константный доступ.
+// Если operator[] возвращает прокси по значению, как SoaVector, итератор возвращает его же: требования
+// C++17 к прямому итератору (reference — это value_type&) он не выполняет и объявляет себя итератором
+// ввода, а для алгоритмов C++20 — итератором произвольного доступа через iterator_concept
+template <typename Owner, bool IsConst>
+class IndexIterator {
+    using Container = std::conditional_t<IsConst, const Owner, Owner>;
+    using Element = decltype(std::declval<Container&>()[size_t{}]);
+
+    static constexpr bool RETURNS_PROXY = !std::is_reference_v<Element>;
+
+public:
+    using iterator_category
+        = std::conditional_t<RETURNS_PROXY, std::input_iterator_tag, std::random_access_iterator_tag>;
+    using iterator_concept = std::random_access_iterator_tag;
+    using value_type = typename Owner::value_type;
+    using difference_type = std::ptrdiff_t;
+    using reference = Element;
+    using pointer = std::conditional_t<RETURNS_PROXY, ArrowProxy<Element>, std::remove_reference_t<Element>*>;
+
+    IndexIterator() noexcept = default;
+
+    IndexIterator(Container* owner, size_t index) noexcept
+        : owner_(owner)
+        , index_(index) {
+    }
+
+    // iterator приводится к const_iterator
+    template <bool OtherConst, typename = std::enable_if_t<IsConst && !OtherConst>>
+    IndexIterator(const IndexIterator<Owner, OtherConst>& other) noexcept
+        : owner_(other.owner_)
+        , index_(other.index_) {
+    }
+
+    reference operator*() const noexcept {
+        return (*owner_)[index_];
+    }
+
+    pointer operator->() const noexcept {
+        if constexpr (RETURNS_PROXY) {
+            return pointer(**this);
+        } else {
+            return &**this;
+        }
+    }
+
+    reference operator[](difference_type offset) const noexcept {
+        return *(*this + offset);
+    }
+
+    IndexIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+
+    IndexIterator operator++(int) noexcept {
+        IndexIterator old = *this;
+        ++index_;
+        return old;
+    }
+
+    IndexIterator& operator--() noexcept {
+        --index_;
+        return *this;
+    }
+
+    IndexIterator operator--(int) noexcept {
+        IndexIterator old = *this;
+        --index_;
+        return old;
+    }
+
+    IndexIterator& operator+=(difference_type offset) noexcept {
+        index_ += offset;
+        return *this;
+    }
+
+    IndexIterator& operator-=(difference_type offset) noexcept {
+        index_ -= offset;
+        return *this;
+    }
+
+    friend IndexIterator operator+(IndexIterator it, difference_type offset) noexcept {
+        return it += offset;
+    }
+
+    friend IndexIterator operator+(difference_type offset, IndexIterator it) noexcept {
+        return it += offset;
+    }
+
+    friend IndexIterator operator-(IndexIterator it, difference_type offset) noexcept {
+        return it -= offset;
+    }
+
+    friend difference_type operator-(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+
+    friend bool operator==(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return lhs.index_ == rhs.index_;
+    }
+
+    friend bool operator!=(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return lhs.index_ != rhs.index_;
+    }
+
+    friend bool operator<(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return lhs.index_ < rhs.index_;
+    }
+
+    friend bool operator>(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return rhs < lhs;
+    }
+
+    friend bool operator<=(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return !(rhs < lhs);
+    }
+
+    friend bool operator>=(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return !(lhs < rhs);
+    }
+
+private:
+    template <typename, bool>
+    friend class IndexIterator;
+
+    Container* owner_ = nullptr;
+    size_t index_ = 0;
+};
+
+}  // namespace detail
@@ -0,0 +1,300 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+#include "vector.h"
+
+namespace detail {
+
+// Встроенный буфер InplaceVector и число элементов в нём
+template <typename T, size_t N>
+struct InplaceBuffer {
+    using Allocator = std::allocator<T>;
+    using Ops = ElementOps<T, Allocator>;
+
+    // Аллокатор без состояния, через который Ops конструирует и разрушает элементы
+    static Allocator& Alloc() noexcept {
+        static Allocator alloc;
+        return alloc;
+    }
+
+    T* Data() noexcept {
+        return reinterpret_cast<T*>(bytes);
+    }
+
+    const T* Data() const noexcept {
+        return reinterpret_cast<const T*>(bytes);
+    }
+
+    void Clear() noexcept {
+        Ops::DestroyN(Alloc(), Data(), size);
+        size = 0;
+    }
+
+    alignas(T) unsigned char bytes[N * sizeof(T)];
+    size_t size = 0;
+};
+
+// Копирование, перемещение и разрушение элементов. Для тривиально копируемых T все специальные
+// функции остаются тривиальными, поэтому InplaceVector можно копировать побайтово (memcpy)
+template <typename T, size_t N, bool = std::is_trivially_copyable_v<T>>
+struct InplaceStorage : InplaceBuffer<T, N> {
+};
+
+template <typename T, size_t N>
+struct InplaceStorage<T, N, false> : InplaceBuffer<T, N> {
+    using Base = InplaceBuffer<T, N>;
+    using typename Base::Ops;
+    using Base::Alloc;
+
+    InplaceStorage() = default;
+
+    InplaceStorage(const InplaceStorage& other)
+        : Base() {
+        Ops::UninitializedCopyN(Alloc(), other.Data(), other.size, this->Data());
+        this->size = other.size;
+    }
+
+    // Встроенный буфер нельзя забрать целиком, поэтому элементы перемещаются поштучно
+    InplaceStorage(InplaceStorage&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : Base() {
+        Ops::UninitializedMoveN(Alloc(), other.Data(), other.size, this->Data());
+        this->size = other.size;
+        other.Clear();
+    }
+
+    InplaceStorage& operator=(const InplaceStorage& rhs) {
+        if (this != &rhs) {
+            Assign(rhs.Data(), rhs.size);
+        }
+        return *this;
+    }
+
+    InplaceStorage& operator=(InplaceStorage&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>
+                                                             && std::is_nothrow_move_assignable_v<T>) {
+        if (this != &rhs) {
+            Assign(std::make_move_iterator(rhs.Data()), rhs.size);
+            rhs.Clear();
+        }
+        return *this;
+    }
+
+    ~InplaceStorage() {
+        this->Clear();
+    }
+
+private:
+    template <typename InputIt>
+    void Assign(InputIt first, size_t count) {
+        Ops::AssignN(Alloc(), first, count, this->Data(), this->size);
+        this->size = count;
+    }
+};
+
+}  // namespace detail
+
+// Вектор ёмкостью N элементов, хранящий их внутри себя и никогда не обращающийся к динамической
+// памяти, по образцу std::inplace_vector. Вставка и удаление выполняются теми же операциями,
+// что и в Vector. При переполнении EmplaceBack, PushBack, Emplace и Resize выбрасывают
+// std::bad_alloc, а TryEmplaceBack и TryPushBack возвращают false, оставляя вектор прежним.
+// Для тривиально копируемых T InplaceVector тоже тривиально копируем, и его можно, например,
+// передавать через кольцевые буферы без блокировок побайтовым копированием
+template <typename T, size_t N>
+class InplaceVector : private detail::InplaceStorage<T, N> {
+    static_assert(N > 0, "InplaceVector must have room for at least one element");
+
+    using Storage = detail::InplaceStorage<T, N>;
+    using Ops = typename Storage::Ops;
+    using Storage::Alloc;
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    InplaceVector() = default;
+
+    explicit InplaceVector(size_t size) {
+        Resize(size);
+    }
+
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    InplaceVector(InputIt first, InputIt last) {
+        for (; first != last; ++first) {
+            EmplaceBack(*first);
+        }
+    }
+
+    InplaceVector(std::initializer_list<T> ilist)
+        : InplaceVector(ilist.begin(), ilist.end()) {
+    }
+
+    // Элементы обмениваются поштучно
+    void Swap(InplaceVector& other) noexcept(std::is_nothrow_swappable_v<T>
+                                             && std::is_nothrow_move_constructible_v<T>) {
+        InplaceVector& shorter = this->size < other.size ? *this : other;
+        InplaceVector& longer = this->size < other.size ? other : *this;
+        const size_t common_size = shorter.size;
+        std::swap_ranges(shorter.begin(), shorter.begin() + common_size, longer.begin());
+        Ops::UninitializedMoveN(Alloc(), longer.begin() + common_size, longer.size - common_size, shorter.end());
+        Ops::DestroyN(Alloc(), longer.begin() + common_size, longer.size - common_size);
+        std::swap(shorter.size, longer.size);
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size > N) {
+            VECTOR_THROW(std::bad_alloc());
+        }
+        if (new_size < this->size) {
+            Ops::DestroyN(Alloc(), begin() + new_size, this->size - new_size);
+        } else {
+            Ops::UninitializedValueConstructN(Alloc(), end(), new_size - this->size);
+        }
+        this->size = new_size;
+    }
+
+    void Clear() noexcept {
+        Storage::Clear();
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        return *Emplace(cend(), std::forward<Args>(args)...);
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Как EmplaceBack, но о переполнении сообщает результатом false, не конструируя элемент
+    template <typename... Args>
+    [[nodiscard]] bool TryEmplaceBack(Args&&... args) {
+        if (this->size == N) {
+            return false;
+        }
+        Ops::Construct(Alloc(), end(), std::forward<Args>(args)...);
+        ++this->size;
+        return true;
+    }
+
+    [[nodiscard]] bool TryPushBack(const T& value) {
+        return TryEmplaceBack(value);
+    }
+
+    [[nodiscard]] bool TryPushBack(T&& value) {
+        return TryEmplaceBack(std::move(value));
+    }
+
+    void PopBack() noexcept {
+        assert(this->size != 0);
+        --this->size;
+        Ops::Destroy(Alloc(), end());
+    }
+
+    iterator Erase(const_iterator pos) noexcept(Ops::NOTHROW_ERASE) {
+        assert(begin() <= pos && pos < end());
+        const size_t offset = pos - cbegin();
+        Ops::Erase(Alloc(), begin(), this->size, offset);
+        --this->size;
+
+        return begin() + offset;
+    }
+
+    iterator Erase(const_iterator first, const_iterator last) noexcept(Ops::NOTHROW_ERASE) {
+        assert(begin() <= first && first <= last && last <= end());
+        const size_t offset = first - cbegin();
+        const size_t count = last - first;
+        if (count != 0) {
+            Ops::EraseRange(Alloc(), begin(), this->size, offset, count);
+            this->size -= count;
+        }
+
+        return begin() + offset;
+    }
+
+    // Удаляет элемент за O(1), перенося на его место последний. Порядок элементов не сохраняется
+    iterator UnorderedErase(const_iterator pos) noexcept(Ops::NOTHROW_ERASE) {
+        assert(begin() <= pos && pos < end());
+        const size_t offset = pos - cbegin();
+        Ops::UnorderedErase(Alloc(), begin(), this->size, offset);
+        --this->size;
+
+        return begin() + offset;
+    }
+
+    // Удаляет элементы, для которых pred возвращает true, и возвращает их число (см. Vector::EraseIf)
+    template <typename Pred>
+    size_t EraseIf(Pred pred) {
+        const size_t old_size = this->size;
+        Ops::RemoveIf(Alloc(), begin(), this->size, pred);
+        return old_size - this->size;
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args) {
+        assert(begin() <= pos && pos <= end());
+        if (this->size == N) {
+            VECTOR_THROW(std::bad_alloc());
+        }
+        const size_t offset = pos - cbegin();
+        Ops::EmplaceInPlace(Alloc(), begin(), this->size, offset, std::forward<Args>(args)...);
+        ++this->size;
+
+        return begin() + offset;
+    }
+
+    iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    size_t Size() const noexcept {
+        return this->size;
+    }
+
+    static constexpr size_t Capacity() noexcept {
+        return N;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<InplaceVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < this->size);
+        return begin()[index];
+    }
+
+    iterator begin() noexcept {
+        return this->Data();
+    }
+
+    iterator end() noexcept {
+        return begin() + this->size;
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return this->Data();
+    }
+
+    const_iterator cend() const noexcept {
+        return cbegin() + this->size;
+    }
+};
@@ -0,0 +1,85 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+#include <cstddef>
+
+// Значения счётчиков CountingInstrumentation на момент вызова Snapshot()
+struct InstrumentationSnapshot {
+    size_t allocations = 0;
+    size_t bytes_allocated = 0;
+    // Замены и расширения на месте буферов существующих векторов
+    size_t reallocations = 0;
+    // Элементы, перенесённые при реаллокациях перемещением (в том числе побайтово) и копированием
+    size_t elements_moved = 0;
+    size_t elements_copied = 0;
+    // Наибольшая ёмкость вектора в элементах
+    size_t peak_capacity = 0;
+};
+
+// Политика инструментирования Vector, накапливающая события всех векторов с одним тегом Tag.
+// Счётчики атомарные, поэтому векторы с общим тегом можно использовать из разных потоков
+template <typename Tag>
+class CountingInstrumentation {
+public:
+    static void OnAllocate(size_t bytes) noexcept {
+        allocations_.fetch_add(1, std::memory_order_relaxed);
+        bytes_allocated_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    static void OnReallocate() noexcept {
+        reallocations_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static void OnTransfer(size_t moved, size_t copied) noexcept {
+        if (moved != 0) {
+            elements_moved_.fetch_add(moved, std::memory_order_relaxed);
+        }
+        if (copied != 0) {
+            elements_copied_.fetch_add(copied, std::memory_order_relaxed);
+        }
+    }
+
+    static void OnCapacity(size_t capacity) noexcept {
+        size_t peak = peak_capacity_.load(std::memory_order_relaxed);
+        while (peak < capacity && !peak_capacity_.compare_exchange_weak(peak, capacity, std::memory_order_relaxed)) {
+        }
+    }
+
+    static InstrumentationSnapshot Snapshot() noexcept {
+        InstrumentationSnapshot snapshot;
+        snapshot.allocations = allocations_.load(std::memory_order_relaxed);
+        snapshot.bytes_allocated = bytes_allocated_.load(std::memory_order_relaxed);
+        snapshot.reallocations = reallocations_.load(std::memory_order_relaxed);
+        snapshot.elements_moved = elements_moved_.load(std::memory_order_relaxed);
+        snapshot.elements_copied = elements_copied_.load(std::memory_order_relaxed);
+        snapshot.peak_capacity = peak_capacity_.load(std::memory_order_relaxed);
+        return snapshot;
+    }
+
+    static void Reset() noexcept {
+        allocations_.store(0, std::memory_order_relaxed);
+        bytes_allocated_.store(0, std::memory_order_relaxed);
+        reallocations_.store(0, std::memory_order_relaxed);
+        elements_moved_.store(0, std::memory_order_relaxed);
+        elements_copied_.store(0, std::memory_order_relaxed);
+        peak_capacity_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    inline static std::atomic<size_t> allocations_{0};
+    inline static std::atomic<size_t> bytes_allocated_{0};
+    inline static std::atomic<size_t> reallocations_{0};
+    inline static std::atomic<size_t> elements_moved_{0};
+    inline static std::atomic<size_t> elements_copied_{0};
+    inline static std::atomic<size_t> peak_capacity_{0};
+};
+
+// Вектор со счётчиками событий, общими для всех векторов с тегом Tag. По умолчанию тегом служит
+// тип элементов; для учёта отдельных мест использования достаточно объявить свой тег:
+//   struct ConnectionBuffers;
+//   InstrumentedVector<char, ConnectionBuffers> buffer;
+//   auto stats = CountingInstrumentation<ConnectionBuffers>::Snapshot();
+template <typename T, typename Tag = T, typename Allocator = std::allocator<T>,
+          typename GrowthPolicy = DoublingGrowth>
+using InstrumentedVector = Vector<T, Allocator, GrowthPolicy, CountingInstrumentation<Tag>>;
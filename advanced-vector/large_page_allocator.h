@@ -0,0 +1,198 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#if !defined(__linux__)
+#error "LargePageAllocator requires Linux (mmap, mremap, mbind)"
+#endif
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "vector.h"
+
+// Способ получения больших страниц для крупных буферов
+enum class HugePages {
+    // Обычные страницы
+    None,
+    // Transparent huge pages: madvise(MADV_HUGEPAGE), ядро подменяет страницы по возможности
+    Transparent,
+    // Зарезервированные страницы (MAP_HUGETLB). Если их не хватает, используются transparent huge pages
+    Explicit,
+};
+
+// Политика размещения памяти по узлам NUMA; значения совпадают с MPOL_* из <numaif.h>
+enum class NumaPolicy : int {
+    Default = 0,
+    Preferred = 1,
+    Bind = 2,
+    Interleave = 3,
+};
+
+struct LargePageOptions {
+    // Буферы от threshold байт отображаются через mmap, меньшие выделяются operator new
+    size_t threshold = size_t{16} << 20;
+    HugePages huge_pages = HugePages::Transparent;
+    NumaPolicy numa_policy = NumaPolicy::Default;
+    // Маска узлов NUMA для numa_policy, отличной от Default
+    uint64_t numa_nodes = 0;
+
+    bool operator==(const LargePageOptions& other) const noexcept {
+        return threshold == other.threshold && huge_pages == other.huge_pages && numa_policy == other.numa_policy
+            && numa_nodes == other.numa_nodes;
+    }
+
+    bool operator!=(const LargePageOptions& other) const noexcept {
+        return !(*this == other);
+    }
+};
+
+// Аллокатор для очень больших векторов. Буферы от options.threshold байт отображаются напрямую через mmap
+// на больших страницах и, при необходимости, привязываются к узлам NUMA. Рост и уменьшение таких буферов
+// выполняются через mremap: try_expand расширяет отображение на месте, reallocate переносит его
+// без копирования данных. Привязка к узлам и большие страницы — подсказки ядру; если они недоступны,
+// память выделяется обычными страницами по политике процесса
+template <typename T>
+class LargePageAllocator {
+    template <typename U>
+    friend class LargePageAllocator;
+
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    static constexpr size_t HUGE_PAGE_SIZE = size_t{2} << 20;
+
+    LargePageAllocator() noexcept = default;
+
+    explicit LargePageAllocator(const LargePageOptions& options) noexcept
+        : options_(options) {
+    }
+
+    template <typename U>
+    LargePageAllocator(const LargePageAllocator<U>& other) noexcept
+        : options_(other.options_) {
+    }
+
+    const LargePageOptions& GetOptions() const noexcept {
+        return options_;
+    }
+
+    T* allocate(size_t n) {
+        return allocate_at_least(n).ptr;
+    }
+
+    // Отображение занимает целое число страниц, и весь его объём доступен под элементы
+    AllocationResult<T> allocate_at_least(size_t n) {
+        if (!IsMapped(n)) {
+            return {std::allocator<T>().allocate(n), n};
+        }
+        if (n > SIZE_MAX / sizeof(T)) {
+            VECTOR_THROW(std::bad_alloc());
+        }
+
+        const size_t length = MappingLength(n);
+        void* p = MAP_FAILED;
+        if (options_.huge_pages == HugePages::Explicit) {
+            p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        }
+        if (p == MAP_FAILED) {
+            p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        }
+        if (p == MAP_FAILED) {
+            VECTOR_THROW(std::bad_alloc());
+        }
+        ApplyPolicy(p, length);
+        return {static_cast<T*>(p), length / sizeof(T)};
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        if (IsMapped(n)) {
+            munmap(static_cast<void*>(p), MappingLength(n));
+        } else {
+            std::allocator<T>().deallocate(p, n);
+        }
+    }
+
+    // Расширяет отображение, не перемещая его, если за ним свободно адресное пространство
+    bool try_expand(T* p, size_t old_n, size_t new_n) noexcept {
+        if (!IsMapped(old_n) || new_n > SIZE_MAX / sizeof(T)) {
+            return false;
+        }
+        const size_t old_length = MappingLength(old_n);
+        const size_t new_length = MappingLength(new_n);
+        if (new_length == old_length) {
+            return true;
+        }
+        if (mremap(static_cast<void*>(p), old_length, new_length, 0) == MAP_FAILED) {
+            return false;
+        }
+        ApplyPolicy(p, new_length);
+        return true;
+    }
+
+    // Изменяет размер блока, перенося его побайтово. Отображение переносится mremap без копирования
+    // данных, остальные блоки копируются. При ошибке исходный блок остаётся действительным
+    T* reallocate(T* p, size_t old_n, size_t new_n) {
+        if (IsMapped(old_n) && IsMapped(new_n) && new_n <= SIZE_MAX / sizeof(T)) {
+            const size_t new_length = MappingLength(new_n);
+            void* new_p = mremap(static_cast<void*>(p), MappingLength(old_n), new_length, MREMAP_MAYMOVE);
+            if (new_p != MAP_FAILED) {
+                ApplyPolicy(new_p, new_length);
+                return static_cast<T*>(new_p);
+            }
+        }
+
+        T* new_p = allocate(new_n);
+        std::memcpy(static_cast<void*>(new_p), static_cast<const void*>(p), std::min(old_n, new_n) * sizeof(T));
+        deallocate(p, old_n);
+        return new_p;
+    }
+
+    // Блоки, выделенные одним аллокатором, может освободить другой, если у них одинаковые параметры
+    template <typename U>
+    bool operator==(const LargePageAllocator<U>& other) const noexcept {
+        return options_ == other.options_;
+    }
+
+    template <typename U>
+    bool operator!=(const LargePageAllocator<U>& other) const noexcept {
+        return !(*this == other);
+    }
+
+private:
+    LargePageOptions options_;
+
+    bool IsMapped(size_t n) const noexcept {
+        return n >= options_.threshold / sizeof(T) && n != 0;
+    }
+
+    // Длина отображения для n элементов. Зависит только от n и параметров аллокатора,
+    // поэтому при освобождении и изменении размера вычисляется заново
+    size_t MappingLength(size_t n) const noexcept {
+        const size_t page_size = options_.huge_pages == HugePages::None ? PageSize() : HUGE_PAGE_SIZE;
+        return (n * sizeof(T) + page_size - 1) / page_size * page_size;
+    }
+
+    static size_t PageSize() noexcept {
+        static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return page_size;
+    }
+
+    void ApplyPolicy(void* p, size_t length) const noexcept {
+        if (options_.huge_pages != HugePages::None) {
+            madvise(p, length, MADV_HUGEPAGE);
+        }
+        if (options_.numa_policy != NumaPolicy::Default) {
+            const uint64_t nodes = options_.numa_nodes;
+            // Ядро считывает maxnode - 1 бит маски
+            syscall(SYS_mbind, p, length, static_cast<int>(options_.numa_policy), &nodes, sizeof(nodes) * 8 + 1, 0);
+        }
+    }
+};
@@ -1,10 +1,39 @@
+#include "aligned_allocator.h"
+#include "concurrent_vector.h"
+#include "incremental_vector.h"
+#include "inplace_vector.h"
+#include "instrumentation.h"
+#include "large_page_allocator.h"
+#include "malloc_allocator.h"
+#include "mapped_vector.h"
+#include "parallel_algorithms.h"
+#include "segmented_vector.h"
+#include "shared_vector.h"
+#include "simd.h"
+#include "small_vector.h"
+#include "soa_vector.h"
+#include "span.h"
+#include "thread_pool.h"
 #include "vector.h"
+#include "vector_io.h"
 
 #include <iostream>
 #include <stdexcept>
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <iterator>
+#include <memory_resource>
+#include <numeric>
+#include <sstream>
+
+#include <sys/wait.h>
+#include <unistd.h>
 
 namespace {
 
@@ -117,8 +146,249 @@ struct Obj {
     static inline int num_move_assigned = 0;
 };
 
+struct AllocationStats {
+    int num_allocations = 0;
+    int num_deallocations = 0;
+    size_t bytes_allocated = 0;
+};
+
+//   :      
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    explicit CountingAllocator(AllocationStats* stats) noexcept
+        : stats(stats) {
+    }
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& other) noexcept
+        : stats(other.stats) {
+    }
+
+    T* allocate(size_t n) {
+        ++stats->num_allocations;
+        stats->bytes_allocated += n * sizeof(T);
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        ++stats->num_deallocations;
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>& other) const noexcept {
+        return stats == other.stats;
+    }
+
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>& other) const noexcept {
+        return stats != other.stats;
+    }
+
+    AllocationStats* stats;
+};
+
+//       ,   
+struct RelocatableObj {
+    explicit RelocatableObj(int value)
+        : value(std::make_unique<int>(value)) {
+    }
+
+    RelocatableObj(RelocatableObj&& other) noexcept
+        : value(std::move(other.value)) {
+        ++num_moved;
+    }
+
+    RelocatableObj& operator=(RelocatableObj&& other) noexcept {
+        value = std::move(other.value);
+        ++num_moved;
+        return *this;
+    }
+
+    ~RelocatableObj() {
+        ++num_destroyed;
+    }
+
+    static void ResetCounters() {
+        num_moved = 0;
+        num_destroyed = 0;
+    }
+
+    std::unique_ptr<int> value;
+
+    static inline int num_moved = 0;
+    static inline int num_destroyed = 0;
+};
+
+struct ExpansionArena {
+    alignas(std::max_align_t) char buffer[1 << 16];
+    size_t used = 0;
+    size_t last_offset = 0;
+};
+
+// ,     .   
+//    ,      
+template <typename T>
+struct ExpandingAllocator {
+    using value_type = T;
+
+    explicit ExpandingAllocator(ExpansionArena* arena) noexcept
+        : arena(arena) {
+    }
+
+    template <typename U>
+    ExpandingAllocator(const ExpandingAllocator<U>& other) noexcept
+        : arena(other.arena) {
+    }
+
+    T* allocate(size_t n) {
+        const size_t bytes = (n * sizeof(T) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+        if (arena->used + bytes > sizeof(arena->buffer)) {
+            throw std::bad_alloc();
+        }
+        arena->last_offset = arena->used;
+        arena->used += bytes;
+        return reinterpret_cast<T*>(arena->buffer + arena->last_offset);
+    }
+
+    void deallocate(T* /*p*/, size_t /*n*/) noexcept {
+    }
+
+    bool try_expand(T* p, size_t /*old_n*/, size_t new_n) noexcept {
+        if (reinterpret_cast<char*>(p) != arena->buffer + arena->last_offset
+            || arena->last_offset + new_n * sizeof(T) > sizeof(arena->buffer)) {
+            return false;
+        }
+        arena->used = arena->last_offset + new_n * sizeof(T);
+        return true;
+    }
+
+    template <typename U>
+    bool operator==(const ExpandingAllocator<U>& other) const noexcept {
+        return arena == other.arena;
+    }
+
+    template <typename U>
+    bool operator!=(const ExpandingAllocator<U>& other) const noexcept {
+        return arena != other.arena;
+    }
+
+    ExpansionArena* arena;
+};
+
+//     .      
+//  allocate,     try_allocate
+template <typename T>
+struct LimitedAllocator {
+    using value_type = T;
+
+    explicit LimitedAllocator(size_t* budget) noexcept
+        : budget(budget) {
+    }
+
+    template <typename U>
+    LimitedAllocator(const LimitedAllocator<U>& other) noexcept
+        : budget(other.budget) {
+    }
+
+    T* allocate(size_t n) {
+        T* p = try_allocate(n);
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return p;
+    }
+
+    T* try_allocate(size_t n) noexcept {
+        if (n > *budget) {
+            return nullptr;
+        }
+        *budget -= n;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        *budget += n;
+        std::allocator<T>().deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const LimitedAllocator<U>& other) const noexcept {
+        return budget == other.budget;
+    }
+
+    template <typename U>
+    bool operator!=(const LimitedAllocator<U>& other) const noexcept {
+        return budget != other.budget;
+    }
+
+    size_t* budget;
+};
+
+//    malloc, reallocate   ,   fail_reallocate
+template <typename T>
+struct FailingReallocAllocator : MallocAllocator<T> {
+    FailingReallocAllocator() noexcept = default;
+
+    template <typename U>
+    FailingReallocAllocator(const FailingReallocAllocator<U>& /*other*/) noexcept {
+    }
+
+    T* reallocate(T* p, size_t old_n, size_t new_n) {
+        if (fail_reallocate) {
+            throw std::bad_alloc();
+        }
+        return MallocAllocator<T>::reallocate(p, old_n, new_n);
+    }
+
+    static inline bool fail_reallocate = false;
+};
+
+//      
+struct AtomicObj {
+    AtomicObj() {
+        if (construction_throw_countdown.fetch_sub(1) == 1) {
+            throw std::runtime_error("Oops");
+        }
+        ++num_alive;
+    }
+
+    AtomicObj(const AtomicObj& other)
+        : value(other.value)  //
+    {
+        if (other.throw_on_copy) {
+            throw std::runtime_error("Oops");
+        }
+        ++num_alive;
+    }
+
+    AtomicObj& operator=(const AtomicObj&) = default;
+
+    ~AtomicObj() {
+        --num_alive;
+    }
+
+    static void ResetCounters() {
+        num_alive = 0;
+        construction_throw_countdown = 0;
+    }
+
+    int value = 1;
+    bool throw_on_copy = false;
+
+    inline static std::atomic<int> num_alive = 0;
+    //     ,     1  0
+    inline static std::atomic<int> construction_throw_countdown = 0;
+};
+
 }  // namespace
 
+template <>
+struct IsTriviallyRelocatable<RelocatableObj> : std::true_type {
+};
+
 void Test1() {
     Obj::ResetCounters();
     const size_t SIZE = 100500;
@@ -433,7 +703,7 @@ void Test6() {
     {
         Obj::ResetCounters();
         Vector<Obj> v;
-        auto* pos = v.Emplace(v.end(), Obj{1});
+        auto pos = v.Emplace(v.end(), Obj{1});
         assert(v.Size() == 1);
         assert(v.Capacity() >= v.Size());
         assert(&*pos == &v[0]);
@@ -448,7 +718,7 @@ void Test6() {
         Obj::ResetCounters();
         Vector<Obj> v;
         v.Reserve(SIZE);
-        auto* pos = v.Emplace(v.end(), Obj{1});
+        auto pos = v.Emplace(v.end(), Obj{1});
         assert(v.Size() == 1);
         assert(v.Capacity() >= v.Size());
         assert(&*pos == &v[0]);
@@ -495,7 +765,7 @@ void Test6() {
     {
         Obj::ResetCounters();
         Vector<Obj> v{SIZE};
-        auto* pos = v.Emplace(v.cbegin() + 1, ID, "Ivan"s);
+        auto pos = v.Emplace(v.cbegin() + 1, ID, "Ivan"s);
         assert(v.Size() == SIZE + 1);
         assert(v.Capacity() == SIZE * 2);
         assert(&*pos == &v[1]);
@@ -511,7 +781,7 @@ void Test6() {
     {
         Obj::ResetCounters();
         Vector<Obj> v{SIZE};
-        auto* pos = v.Emplace(v.cbegin() + v.Size(), ID, "Ivan"s);
+        auto pos = v.Emplace(v.cbegin() + v.Size(), ID, "Ivan"s);
         assert(v.Size() == SIZE + 1);
         assert(v.Capacity() == SIZE * 2);
         assert(&*pos == &v[SIZE]);
@@ -530,7 +800,7 @@ void Test6() {
         v.Reserve(SIZE * 2);
         const int old_num_moved = Obj::num_moved;
         assert(v.Capacity() == SIZE * 2);
-        auto* pos = v.Emplace(v.cbegin() + 3, ID, "Ivan"s);
+        auto pos = v.Emplace(v.cbegin() + 3, ID, "Ivan"s);
         assert(v.Size() == SIZE + 1);
         assert(&*pos == &v[3]);
         assert(v[3].id == ID);
@@ -546,7 +816,7 @@ void Test6() {
         Obj::ResetCounters();
         Vector<Obj> v{SIZE};
         v[2].id = ID;
-        auto* pos = v.Erase(v.cbegin() + 1);
+        auto pos = v.Erase(v.cbegin() + 1);
         assert((pos - v.begin()) == 1);
         assert(v.Size() == SIZE - 1);
         assert(v.Capacity() == SIZE);
@@ -559,85 +829,2037 @@ void Test6() {
     }
 }
 
-struct C {
-    C() noexcept {
-        ++def_ctor;
+void Test7() {
+    using namespace std::literals;
+    const size_t SIZE = 10;
+    {
+        AllocationStats stats;
+        {
+            Vector<int, CountingAllocator<int>> v{CountingAllocator<int>(&stats)};
+            for (size_t i = 0; i < SIZE; ++i) {
+                v.PushBack(static_cast<int>(i));
+            }
+            assert(stats.num_allocations == 5);
+            assert(stats.bytes_allocated == (1 + 2 + 4 + 8 + 16) * sizeof(int));
+
+            const auto v_copy(v);
+            assert(v_copy.GetAllocator() == v.GetAllocator());
+            assert(stats.num_allocations == 6);
+        }
+        assert(stats.num_allocations == stats.num_deallocations);
     }
-    C(const C& /*other*/) noexcept {
-        ++copy_ctor;
+    {
+        AllocationStats lhs_stats;
+        AllocationStats rhs_stats;
+        {
+            Obj::ResetCounters();
+            Vector<Obj, CountingAllocator<Obj>> lhs{CountingAllocator<Obj>(&lhs_stats)};
+            Vector<Obj, CountingAllocator<Obj>> rhs{SIZE, CountingAllocator<Obj>(&rhs_stats)};
+            //      ,    
+            lhs = std::move(rhs);
+            assert(lhs.Size() == SIZE);
+            assert(lhs.GetAllocator() == CountingAllocator<Obj>(&lhs_stats));
+            assert(lhs_stats.num_allocations == 1);
+            assert(rhs_stats.num_allocations == 1);
+            assert(Obj::num_moved == SIZE);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+        assert(lhs_stats.num_allocations == lhs_stats.num_deallocations);
+        assert(rhs_stats.num_allocations == rhs_stats.num_deallocations);
     }
-    C(C&& /*other*/) noexcept {
-        ++move_ctor;
+    {
+        char buffer[4096];
+        std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer), std::pmr::null_memory_resource());
+        pmr::Vector<std::pmr::string> v(&arena);
+        v.EmplaceBack("a string that is too long for the small string optimization"s);
+        v.EmplaceBack(v[0]);
+        assert(v.Size() == 2);
+        assert(v[1] == v[0]);
+        assert(v.GetAllocator().resource() == &arena);
+        assert(v[1].get_allocator().resource() == &arena);
     }
-    C& operator=(const C& other) noexcept {
-        if (this != &other) {
-            ++copy_assign;
+}
+
+void Test8() {
+    const int SIZE = 10;
+    RelocatableObj::ResetCounters();
+    {
+        Vector<RelocatableObj> v;
+        for (int i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(i);
         }
-        return *this;
+        //    ,     
+        assert(RelocatableObj::num_moved == 0);
+        assert(RelocatableObj::num_destroyed == 0);
+
+        v.Reserve(SIZE * 10);
+        assert(RelocatableObj::num_moved == 0);
+        assert(RelocatableObj::num_destroyed == 0);
+        assert(*v[0].value == 0 && *v[SIZE - 1].value == SIZE - 1);
+
+        //      
+        v.Emplace(v.cbegin() + 1, SIZE);
+        assert(RelocatableObj::num_moved == 0);
+        assert(RelocatableObj::num_destroyed == 0);
+        assert(*v[1].value == SIZE && *v[2].value == 1);
     }
-    C& operator=(C&& /*other*/) noexcept {
-        ++move_assign;
-        return *this;
+    assert(RelocatableObj::num_destroyed == SIZE + 1);
+    {
+        Vector<std::unique_ptr<int>> v;
+        v.PushBack(std::make_unique<int>(SIZE));
+        v.PushBack(std::move(v[0]));
+        assert(v[0] == nullptr);
+        assert(*v[1] == SIZE);
+    }
+}
+
+void Test9() {
+    const size_t SIZE = 100;
+    {
+        ExpansionArena arena;
+        Obj::ResetCounters();
+        {
+            Vector<Obj, ExpandingAllocator<Obj>> v{SIZE, ExpandingAllocator<Obj>(&arena)};
+            const Obj* address = &v[0];
+            v.Reserve(SIZE * 2);
+            assert(v.Capacity() == SIZE * 2);
+            assert(&v[0] == address);
+            assert(Obj::num_moved == 0);
+
+            v.Resize(SIZE * 2);
+            v.EmplaceBack(v[0]);
+            assert(v.Capacity() == SIZE * 4);
+            assert(&v[0] == address);
+            assert(Obj::num_moved == 0);
+            assert(Obj::num_copied == 1);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
     }
-    ~C() {
-        ++dtor;
+    {
+        Vector<int, MallocAllocator<int>> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.Insert(v.cbegin() + i / 2, static_cast<int>(i));
+        }
+        v.PushBack(v[0]);
+        v.Reserve(SIZE * 100);
+        assert(v.Capacity() == SIZE * 100);
+        assert(v.Size() == SIZE + 1);
+        assert(v[0] == 1 && v[SIZE - 1] == 0 && v[SIZE] == 1);
+    }
+    {
+        RelocatableObj::ResetCounters();
+        {
+            Vector<RelocatableObj, MallocAllocator<RelocatableObj>> v;
+            for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+                v.EmplaceBack(i);
+            }
+            assert(RelocatableObj::num_moved == 0);
+            assert(*v[SIZE - 1].value == static_cast<int>(SIZE - 1));
+        }
+        assert(RelocatableObj::num_destroyed == static_cast<int>(SIZE));
     }
+}
 
-    static void Reset() {
-        def_ctor = 0;
-        copy_ctor = 0;
-        move_ctor = 0;
-        copy_assign = 0;
-        move_assign = 0;
-        dtor = 0;
+void Test10() {
+    {
+        Vector<int, std::allocator<int>, GeometricGrowth<>> v;
+        v.PushBack(1);
+        assert(v.Capacity() == 64 / sizeof(int));
+        v.Resize(v.Capacity());
+        v.PushBack(1);
+        assert(v.Capacity() == 64 / sizeof(int) * 3 / 2);
+    }
+    {
+        const size_t MAX_STEP = 4096;
+        Vector<char, std::allocator<char>, GeometricGrowth<2, 1, 4096, MAX_STEP>> v;
+        v.PushBack('a');
+        assert(v.Capacity() == 4096);
+        v.Resize(v.Capacity() * 4);
+        v.PushBack('b');
+        assert(v.Capacity() == 4096 * 4 + MAX_STEP);
+    }
+    {
+        Vector<char, MallocAllocator<char>> v;
+        v.PushBack('a');
+        assert(v.Capacity() >= 1);
+#if VECTOR_MALLOC_USABLE_SIZE && defined(__GLIBC__)
+        //  ,  malloc,   
+        assert(v.Capacity() == malloc_usable_size(&v[0]));
+#else
+        assert(v.Capacity() == 1);
+#endif
+    }
+    {
+        //  n * sizeof(T)       
+        MallocAllocator<int64_t> alloc;
+        bool thrown = false;
+        try {
+            static_cast<void>(alloc.allocate(static_cast<size_t>(-1) / 4));
+        } catch (const std::bad_array_new_length&) {
+            thrown = true;
+        }
+        assert(thrown && alloc.try_allocate(static_cast<size_t>(-1) / 4) == nullptr);
     }
+}
 
-    inline static size_t def_ctor = 0;
-    inline static size_t copy_ctor = 0;
-    inline static size_t move_ctor = 0;
-    inline static size_t copy_assign = 0;
-    inline static size_t move_assign = 0;
-    inline static size_t dtor = 0;
-};
+void Test11() {
+    const size_t INLINE_SIZE = 8;
+    const size_t SIZE = 100;
+    const int ID = 42;
+    {
+        Obj::ResetCounters();
+        SmallVector<Obj, INLINE_SIZE> v;
+        assert(v.IsInline());
+        assert(v.Capacity() == INLINE_SIZE);
+        for (size_t i = 0; i < INLINE_SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        assert(v.IsInline());
+        assert(Obj::num_moved == 0);
 
-void Dump() {
-    using namespace std;
-    cerr << "Def ctors: "sv << C::def_ctor              //
-         << ", Copy ctors: "sv << C::copy_ctor          //
-         << ", Move ctors: "sv << C::move_ctor          //
-         << ", Copy assignments: "sv << C::copy_assign  //
-         << ", Move assignments: "sv << C::move_assign  //
-         << ", Dtors: "sv << C::dtor << endl;
-}
+        v.Insert(v.cbegin() + 1, Obj{ID});
+        assert(!v.IsInline());
+        assert(v.Size() == INLINE_SIZE + 1);
+        assert(v.Capacity() == INLINE_SIZE * 2);
+        assert(v[1].id == ID && v[2].id == 1);
+        assert(Obj::num_moved == INLINE_SIZE + 1);
 
-void Benchmark() {
-    using namespace std;
-    try {
-        const size_t NUM = 10;
-        C c;
+        v.Erase(v.cbegin() + 1);
+        assert(v.Size() == INLINE_SIZE && v[1].id == 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Obj::ResetCounters();
+        SmallVector<Obj, INLINE_SIZE> v(INLINE_SIZE / 2);
+        v[0].id = ID;
+        SmallVector<Obj, INLINE_SIZE> moved(std::move(v));
+        assert(v.Size() == 0);
+        assert(moved.IsInline() && moved.Size() == INLINE_SIZE / 2 && moved[0].id == ID);
+
+        SmallVector<Obj, INLINE_SIZE> large(SIZE);
+        large.Swap(moved);
+        assert(large.IsInline() && large.Size() == INLINE_SIZE / 2 && large[0].id == ID);
+        assert(!moved.IsInline() && moved.Size() == SIZE);
+
+        moved = large;
+        assert(!moved.IsInline() && moved.Size() == INLINE_SIZE / 2 && moved[0].id == ID);
+        assert(Obj::GetAliveObjectCount() == INLINE_SIZE);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Obj::ResetCounters();
+        Obj::default_construction_throw_countdown = INLINE_SIZE / 2;
+        try {
+            SmallVector<Obj, INLINE_SIZE> v(INLINE_SIZE);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        Obj::ResetCounters();
+        SmallVector<Obj, INLINE_SIZE> v(INLINE_SIZE);
+        try {
+            v[INLINE_SIZE / 2].throw_on_copy = true;
+            SmallVector<Obj, INLINE_SIZE> v_copy(v);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+            assert(Obj::num_copied == INLINE_SIZE / 2);
+        }
+        assert(Obj::GetAliveObjectCount() == INLINE_SIZE);
+        v.Reserve(SIZE);
+        assert(!v.IsInline() && v.Capacity() == SIZE);
+        assert(Obj::GetAliveObjectCount() == INLINE_SIZE);
+    }
+    {
+        SmallVector<TestObj, 1> v(1);
+        v.PushBack(v[0]);
+        v.Emplace(v.cbegin(), std::move(v[1]));
+        assert(std::all_of(v.begin(), v.end(), [](const TestObj& obj) {
+            return obj.IsAlive();
+        }));
+    }
+    //        
+    {
+        AllocationStats lhs_stats;
+        AllocationStats rhs_stats;
         {
-            cerr << "std::vector:"sv << endl;
-            C::Reset();
-            vector<C> v(NUM);
-            Dump();
-            v.push_back(c);
+            using CountingVector = SmallVector<int, 2, CountingAllocator<int>>;
+            CountingVector lhs{CountingAllocator<int>(&lhs_stats)};
+            CountingVector rhs(SIZE, CountingAllocator<int>(&rhs_stats));
+            rhs[SIZE - 1] = ID;
+            lhs = rhs;
+            assert(lhs.Size() == SIZE && lhs[SIZE - 1] == ID && !lhs.IsInline());
+            assert(lhs.GetAllocator() == CountingAllocator<int>(&lhs_stats));
+            assert(lhs_stats.num_allocations == 1 && rhs_stats.num_allocations == 1);
         }
-        Dump();
-    } catch (...) {
+        assert(lhs_stats.num_allocations == lhs_stats.num_deallocations);
+        assert(rhs_stats.num_allocations == rhs_stats.num_deallocations);
     }
-    try {
-        const size_t NUM = 10;
-        C c;
+    {
+        std::pmr::unsynchronized_pool_resource pool;
+        using PmrVector = SmallVector<int, 2, std::pmr::polymorphic_allocator<int>>;
+        PmrVector lhs{std::pmr::polymorphic_allocator<int>(&pool)};
+        PmrVector rhs(SIZE);
+        lhs = rhs;
+        assert(lhs.Size() == SIZE && lhs.GetAllocator().resource() == &pool);
+        rhs.Resize(1);
+        lhs = rhs;
+        assert(lhs.Size() == 1 && lhs.GetAllocator().resource() == &pool);
+    }
+}
+
+void Test12() {
+    using namespace std::literals;
+    const size_t SIZE = 10;
+    const int ID = 42;
+    {
+        AllocationStats stats;
+        Obj::ResetCounters();
         {
-            cerr << "Vector:"sv << endl;
-            C::Reset();
-            Vector<C> v(NUM);
-            Dump();
-            v.PushBack(c);
+            Vector<Obj, CountingAllocator<Obj>> v{CountingAllocator<Obj>(&stats)};
+            v.Reserve(SIZE * 3);
+            v.Resize(SIZE);
+            for (size_t i = 0; i < SIZE; ++i) {
+                v.Emplace(v.cbegin() + i, ID, "Ivan"s);
+                v.Insert(v.cbegin() + 1, v[SIZE / 2]);
+            }
+            assert(v.Size() == SIZE * 3);
+            //         
+            assert(stats.num_allocations == 1);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        Vector<int> v(SIZE);
+        v.Reserve(SIZE * 2);
+        v[SIZE - 1] = ID;
+        //    ,    
+        v.Insert(v.cbegin(), v[SIZE - 1]);
+        v.Emplace(v.cbegin() + 1, std::move(v[SIZE]));
+        assert(v[0] == ID && v[1] == ID && v[SIZE + 1] == ID);
+        v.Emplace(v.cbegin() + 1);
+        assert(v[1] == 0 && v.Size() == SIZE + 3);
+    }
+    {
+        // -   ,    
+        struct Node {
+            explicit Node(int value) noexcept
+                : value(value) {
+            }
+            explicit Node(const Node* other) noexcept
+                : value(other->value) {
+            }
+            int value;
+        };
+        Vector<Node> v;
+        v.Reserve(SIZE);
+        for (int i = 0; i < 3; ++i) {
+            v.EmplaceBack(i);
+        }
+        v.Emplace(v.cbegin(), &v[1]);
+        assert(v.Size() == 4 && v[0].value == 1 && v[1].value == 0 && v[2].value == 1);
+    }
+}
+
+void Test13() {
+    const size_t SIZE = 10;
+    const int ID = 42;
+    {
+        const std::vector<int> source{1, 2, 3};
+        Vector<int> v(source.begin(), source.end());
+        assert(v.Size() == source.size() && v.Capacity() == source.size());
+        assert(std::equal(v.begin(), v.end(), source.begin()));
+
+        v.Insert(v.cbegin() + 1, {4, 5});
+        v.Insert(v.cbegin(), 2, v[4]);
+        v.Append(source);
+        const std::vector<int> expected{3, 3, 1, 4, 5, 2, 3, 1, 2, 3};
+        assert(v.Size() == expected.size());
+        assert(std::equal(v.begin(), v.end(), expected.begin()));
+
+        auto pos = v.Erase(v.cbegin() + 1, v.cbegin() + 4);
+        assert(pos == v.begin() + 1 && *pos == 5 && v.Size() == expected.size() - 3);
+        v.Erase(v.cbegin(), v.cend());
+        assert(v.Size() == 0);
+    }
+    {
+        std::istringstream input("1 2 3 4");
+        Vector<int> v{SIZE};
+        v.Insert(v.cbegin() + 1, std::istream_iterator<int>(input), std::istream_iterator<int>());
+        assert(v.Size() == SIZE + 4);
+        assert(v[0] == 0 && v[1] == 1 && v[4] == 4 && v[5] == 0);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> source(SIZE);
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 3);
+        v[0].id = ID;
+        const int old_num_moved = Obj::num_moved;
+        v.Insert(v.cbegin(), source.begin(), source.end());
+        //    ,   
+        assert(v.Size() == SIZE * 2 && v.Capacity() == SIZE * 3);
+        assert(v[SIZE].id == ID);
+        assert(Obj::num_copied == SIZE);
+        assert(Obj::num_moved - old_num_moved == SIZE);
+
+        //    ,   
+        source[SIZE / 2].throw_on_copy = true;
+        try {
+            v.Insert(v.cbegin() + 1, source.begin(), source.end());
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == SIZE * 2 && v[SIZE].id == ID);
+        try {
+            v.Insert(v.cbegin() + 1, source.begin(), source.end());
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == SIZE * 2 && v.Capacity() == SIZE * 3 && v[SIZE].id == ID);
+        assert(Obj::GetAliveObjectCount() == SIZE * 3);
+
+        v.Assign(source.begin(), source.begin() + SIZE / 2);
+        assert(v.Size() == SIZE / 2 && v.Capacity() == SIZE * 3);
+        assert(Obj::GetAliveObjectCount() == SIZE + SIZE / 2);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<std::string> v;
+        v.Assign({"a", "b", "c"});
+        v.Insert(v.cbegin() + 1, SIZE, "x");
+        assert(v.Size() == SIZE + 3 && v[0] == "a" && v[1] == "x" && v[SIZE + 1] == "b");
+    }
+}
+
+void Test14() {
+    const size_t SIZE = 1 << 20;
+    const uint8_t MAGIC = 42;
+    {
+        Vector<uint8_t> v(SIZE, default_init);
+        assert(v.Size() == SIZE && v.Capacity() == SIZE);
+        std::fill(v.begin(), v.end(), MAGIC);
+
+        v.ResizeUninitialized(SIZE * 2);
+        assert(v.Size() == SIZE * 2);
+        assert(v[SIZE - 1] == MAGIC);
+        v[SIZE * 2 - 1] = MAGIC;
+
+        v.Resize(SIZE / 2, default_init);
+        assert(v.Size() == SIZE / 2 && v.Capacity() == SIZE * 2 && v[0] == MAGIC);
+    }
+    {
+        Vector<float> v;
+        v.Resize(SIZE, default_init);
+        v[SIZE - 1] = 1.0f;
+        assert(v.Size() == SIZE && v[SIZE - 1] == 1.0f);
+    }
+}
+
+void Test15() {
+    struct Moved;
+    struct Copied;
+    //    ,     
+    struct ThrowingMove {
+        ThrowingMove() = default;
+        ThrowingMove(const ThrowingMove&) = default;
+        ThrowingMove(ThrowingMove&& /*other*/) noexcept(false) {
+        }
+        ThrowingMove& operator=(const ThrowingMove&) = default;
+    };
+    using MovedStats = CountingInstrumentation<Moved>;
+    using CopiedStats = CountingInstrumentation<Copied>;
+    MovedStats::Reset();
+    CopiedStats::Reset();
+    {
+        InstrumentedVector<Obj, Moved> v;
+        for (int i = 0; i < 5; ++i) {
+            v.EmplaceBack(i);
+        }
+        // : 1, 2, 4, 8
+        const auto stats = MovedStats::Snapshot();
+        assert(stats.allocations == 4 && stats.reallocations == 4);
+        assert(stats.bytes_allocated == (1 + 2 + 4 + 8) * sizeof(Obj));
+        assert(stats.elements_moved == 0 + 1 + 2 + 4 && stats.elements_copied == 0);
+        assert(stats.peak_capacity == 8);
+
+        const InstrumentedVector<Obj, Moved> copy(v);
+        assert(MovedStats::Snapshot().allocations == 5 && MovedStats::Snapshot().reallocations == 4);
+    }
+    {
+        InstrumentedVector<ThrowingMove, Copied> v(3);
+        v.Reserve(10);
+        v.EmplaceBack();
+        const auto stats = CopiedStats::Snapshot();
+        assert(stats.allocations == 2 && stats.reallocations == 1);
+        assert(stats.elements_moved == 0 && stats.elements_copied == 3);
+        assert(stats.peak_capacity == 10);
+    }
+    MovedStats::Reset();
+    assert(MovedStats::Snapshot().allocations == 0 && MovedStats::Snapshot().peak_capacity == 0);
+    //      ,    
+    static_assert(sizeof(InstrumentedVector<int>) == sizeof(Vector<int>));
+}
+
+void Test16() {
+    Obj::ResetCounters();
+    {
+        Vector<Obj> v;
+        v.Reserve(10);
+        v.EmplaceBack(1);
+        v.EmplaceBack(2);
+        v.ShrinkToFit();
+        assert(v.Size() == 2 && v.Capacity() == 2 && v[0].id == 1 && v[1].id == 2);
+
+        v.Clear();
+        assert(v.Size() == 0 && v.Capacity() == 2);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0 && v.Data() == nullptr);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        const size_t SIZE = 1024;
+        Vector<int, std::allocator<int>, ShrinkingGrowth<>> v(SIZE);
+        v.Resize(SIZE / 4);
+        assert(v.Capacity() == SIZE);
+        v.Resize(SIZE / 4 - 1);
+        assert(v.Capacity() == SIZE / 2 - 2);
+        v.Resize(SIZE / 8 - 2, default_init);
+        assert(v.Size() == SIZE / 8 - 2 && v.Capacity() == SIZE / 4 - 4);
+
+        //        
+        const int* data = v.Data();
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(i);
+            v.PopBack();
+        }
+        assert(v.Data() == data);
+
+        v.Erase(v.begin() + 1, v.end());
+        assert(v.Size() == 1 && v.Capacity() == 2);
+        //     
+        v.PopBack();
+        assert(v.Size() == 0 && v.Capacity() == 2);
+    }
+    {
+        //    realloc
+        Vector<int, MallocAllocator<int>, ShrinkingGrowth<>> v(1000);
+        v[0] = 42;
+        v.Erase(v.begin() + 10, v.end());
+        assert(v.Size() == 10 && v.Capacity() >= 20 && v.Capacity() < 1000 && v[0] == 42);
+    }
+    Obj::ResetCounters();
+    {
+        Vector<Obj, std::allocator<Obj>, ShrinkingGrowth<>> v(16);
+        for (int i = 0; i < 12; ++i) {
+            v.Erase(v.begin());
+        }
+        assert(v.Size() == 4 && v.Capacity() == 16);
+        v.Erase(v.begin());
+        assert(v.Size() == 3 && v.Capacity() == 6);
+        v.PopBack();
+        assert(v.Size() == 2 && v.Capacity() == 6);
+        v.Clear();
+        assert(v.Capacity() == 6);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test17() {
+    LargePageOptions options;
+    options.threshold = 1 << 20;
+    const size_t SIZE = 1 << 20;
+    {
+        //     
+        Vector<int, LargePageAllocator<int>> v(10, LargePageAllocator<int>(options));
+        assert(v.Capacity() == 10);
+    }
+    for (HugePages huge_pages : {HugePages::None, HugePages::Transparent, HugePages::Explicit}) {
+        options.huge_pages = huge_pages;
+        Vector<int, LargePageAllocator<int>> v{LargePageAllocator<int>(options)};
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<int>(i));
+        }
+        //       
+        assert(v.Size() == SIZE && v.Capacity() >= SIZE);
+        assert(v.Capacity() * sizeof(int) % 4096 == 0);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i] == static_cast<int>(i));
+        }
+
+        v.Resize(SIZE / 8);
+        v.ShrinkToFit();
+        assert(v.Size() == SIZE / 8 && v[SIZE / 8 - 1] == static_cast<int>(SIZE / 8 - 1));
+        v.ShrinkToFit();
+        v.Resize(4);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 4 && v[3] == 3);
+    }
+    {
+        //        try_expand
+        options.numa_policy = NumaPolicy::Bind;
+        options.numa_nodes = 1;
+        Vector<std::string, LargePageAllocator<std::string>> v{LargePageAllocator<std::string>(options)};
+        v.Reserve(SIZE / sizeof(std::string));
+        v.EmplaceBack("first");
+        v.Reserve(SIZE);
+        assert(v.Capacity() >= SIZE && v[0] == "first");
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack();
+        }
+        assert(v[0] == "first" && v.Size() == SIZE + 1);
+        assert(v.GetAllocator().GetOptions() == options);
+    }
+}
+
+void Test18() {
+    struct Record {
+        uint64_t key;
+        double value;
+    };
+    const std::string path = "/tmp/mapped_vector_test_" + std::to_string(getpid());
+    const size_t SIZE = 100000;
+    std::remove(path.c_str());
+    {
+        MappedVector<Record> v(path, 3);
+        assert(v.Size() == 0 && v.Capacity() > 0 && v.Version() == 3);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack({i, i * 0.5});
+        }
+        //    ,     
+        while (v.Size() < v.Capacity()) {
+            v.PushBack(v[0]);
+        }
+        v.EmplaceBack(v[1]);
+        assert(v[v.Size() - 1].key == 1);
+        v.Resize(SIZE);
+        v.Flush();
+    }
+    {
+        MappedVector<Record> v(path, 3);
+        assert(v.Size() == SIZE && v.Capacity() >= SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            assert(v[i].key == i && v[i].value == i * 0.5);
+        }
+        v.Resize(SIZE + 1);
+        assert(v[SIZE].key == 0 && v[SIZE].value == 0.0);
+        v.PopBack();
+
+        MappedVector<Record> moved(std::move(v));
+        moved.Reserve(SIZE * 4);
+        assert(moved.Capacity() >= SIZE * 4 && moved[SIZE - 1].key == SIZE - 1);
+        moved.FlushAsync();
+    }
+    {
+        //       
+        bool thrown = false;
+        try {
+            MappedVector<uint64_t> v(path, 3);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+        thrown = false;
+        try {
+            MappedVector<Record> v(path, 4);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+        thrown = false;
+        try {
+            MappedVector<Record> v("/nonexistent/mapped_vector");
+        } catch (const std::system_error& e) {
+            thrown = e.code() == std::errc::no_such_file_or_directory;
+        }
+        assert(thrown);
+    }
+    {
+        MappedVector<Record> v(path, 3);
+        assert(v.Size() == SIZE);
+        v.Clear();
+    }
+    assert(MappedVector<Record>(path, 3).Size() == 0);
+    std::remove(path.c_str());
+}
+
+void Test19() {
+    Obj::ResetCounters();
+    {
+        Vector<Obj> v;
+        v.Reserve(4);
+        v.EmplaceBack(1);
+        v.EmplaceBack(2);
+        const Obj* data = v.Data();
+
+        ReleasedBuffer<Obj> buffer = v.Release();
+        assert(v.Size() == 0 && v.Capacity() == 0 && v.Data() == nullptr);
+        assert(buffer.ptr == data && buffer.size == 2 && buffer.capacity == 4);
+        assert(Obj::GetAliveObjectCount() == 2);
+
+        Vector<Obj> adopted(adopt, buffer.ptr, buffer.size, buffer.capacity, v.GetAllocator());
+        assert(adopted.Data() == data && adopted.Size() == 2 && adopted.Capacity() == 4);
+        assert(adopted[1].id == 2);
+        adopted.EmplaceBack(3);
+        assert(adopted.Data() == data && Obj::num_copied == 0 && Obj::num_moved == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<uint8_t> payload(16);
+        std::iota(payload.begin(), payload.end(), uint8_t{0});
+        Span<uint8_t> span(payload);
+        assert(span.Data() == payload.Data() && span.Size() == 16);
+        assert(span.Subspan(4, 2)[1] == 5 && span.First(3).Size() == 3 && span.Last(1)[0] == 15);
+
+        const Vector<uint8_t>& const_payload = payload;
+        Span const_span(const_payload);
+        static_assert(std::is_same_v<decltype(const_span), Span<const uint8_t>>);
+        const Span<const uint8_t> converted = span;
+        assert(AsBytes(converted).Size() == 16 && AsWritableBytes(span).Data() == AsBytes(span).Data());
+
+        SmallVector<uint32_t, 4> header;
+        header.PushBack(16);
+        std::array<iovec, 2> iovecs = MakeIovecs(header, payload);
+        assert(iovecs[0].iov_base == header.begin() && iovecs[0].iov_len == sizeof(uint32_t));
+        assert(iovecs[1].iov_base == payload.Data() && iovecs[1].iov_len == 16);
+
+        Vector<Vector<uint8_t>> chunks;
+        chunks.PushBack(payload);
+        chunks.PushBack(payload);
+        Vector<iovec> chunk_iovecs;
+        AppendIovecs(chunk_iovecs, chunks);
+        assert(chunk_iovecs.Size() == 2 && chunk_iovecs[1].iov_base == chunks[1].Data());
+
+        int fds[2];
+        [[maybe_unused]] const int result = pipe(fds);
+        assert(result == 0);
+        WriteAll(fds[1], Span<iovec>(iovecs.data(), iovecs.size()));
+        close(fds[1]);
+
+        Vector<uint8_t> received(sizeof(uint32_t) + 16, default_init);
+        assert(read(fds[0], received.Data(), received.Size()) == static_cast<ssize_t>(received.Size()));
+        close(fds[0]);
+        uint32_t length = 0;
+        std::memcpy(&length, received.Data(), sizeof(length));
+        assert(length == 16 && std::equal(payload.begin(), payload.end(), received.begin() + sizeof(length)));
+    }
+    {
+        //       
+        const Vector<uint8_t> empty;
+        Vector<uint8_t> payload(3);
+        std::iota(payload.begin(), payload.end(), uint8_t{1});
+        std::array<iovec, 3> iovecs = MakeIovecs(empty, payload, empty);
+        int fds[2];
+        [[maybe_unused]] const int result = pipe(fds);
+        assert(result == 0);
+        WriteAll(fds[1], Span<iovec>(iovecs.data(), iovecs.size()));
+        WriteAll(fds[1], Span<iovec>(iovecs.data(), 1));
+        close(fds[1]);
+        uint8_t received[4] = {};
+        assert(read(fds[0], received, sizeof(received)) == 3 && received[2] == 3);
+        close(fds[0]);
+    }
+}
+
+void Test20() {
+    const size_t SIZE = 1 << 18;
+    ThreadPool pool(4);
+    assert(pool.Concurrency() == 4);
+    AtomicObj::ResetCounters();
+    {
+        Vector<AtomicObj> v(SIZE, pool);
+        assert(v.Size() == SIZE && AtomicObj::num_alive == static_cast<int>(SIZE));
+        v[SIZE - 1].value = 2;
+
+        Vector<AtomicObj> copy(v, pool);
+        assert(copy.Size() == SIZE && copy[SIZE - 1].value == 2);
+        assert(AtomicObj::num_alive == static_cast<int>(SIZE * 2));
+
+        Vector<AtomicObj> small(10);
+        small.Assign(v, pool);
+        assert(small.Size() == SIZE && small[SIZE - 1].value == 2);
+        assert(AtomicObj::num_alive == static_cast<int>(SIZE * 3));
+
+        copy.Clear(pool);
+        assert(copy.Size() == 0 && copy.Capacity() == SIZE);
+        assert(AtomicObj::num_alive == static_cast<int>(SIZE * 2));
+
+        //   :  ,   , 
+        AtomicObj::construction_throw_countdown = SIZE / 2;
+        try {
+            Vector<AtomicObj> failed(SIZE, pool);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(AtomicObj::num_alive == static_cast<int>(SIZE * 2));
+        AtomicObj::construction_throw_countdown = 0;
+
+        //   : ,   ,  
+        v[SIZE / 3].throw_on_copy = true;
+        try {
+            small.Assign(v, pool);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(small.Size() == SIZE && !small[SIZE / 3].throw_on_copy);
+        assert(AtomicObj::num_alive == static_cast<int>(SIZE * 2));
+    }
+    assert(AtomicObj::num_alive == 0);
+    {
+        //      
+        std::atomic<size_t> calls = 0;
+        pool.ParallelFor(8, [&](size_t) {
+            pool.ParallelFor(8, [&](size_t) {
+                ++calls;
+            });
+        });
+        assert(calls == 64);
+
+        ThreadPool serial(1);
+        Vector<int> v(SIZE, serial);
+        assert(v.Size() == SIZE && v[SIZE - 1] == 0);
+    }
+}
+
+void Test21() {
+    const size_t SIZE = 1 << 20;
+    ThreadPool pool(4);
+    {
+        //     -     
+        Vector<uint32_t> v(SIZE + 3);
+        const detail::ParallelChunks<uint32_t> chunks(v.Data() + 3, SIZE, pool.Concurrency());
+        assert(chunks.Count() > 1 && chunks.Begin(0) == 0 && chunks.Begin(chunks.Count()) == SIZE);
+        for (size_t i = 1; i < chunks.Count(); ++i) {
+            assert(reinterpret_cast<uintptr_t>(v.Data() + 3 + chunks.Begin(i)) % detail::CACHE_LINE_SIZE == 0);
+            assert(chunks.Size(i - 1) > 0);
+        }
+        assert(detail::ParallelChunks<int>(nullptr, 0, 4).Count() == 0);
+    }
+    {
+        Vector<uint64_t> v(SIZE);
+        ParallelForEach(pool, v, [](uint64_t& x) {
+            x = 1;
+        });
+        assert(std::count(v.begin(), v.end(), 1u) == static_cast<std::ptrdiff_t>(SIZE));
+
+        std::iota(v.begin(), v.end(), uint64_t{0});
+        assert(ParallelReduce(pool, v, uint64_t{0}) == uint64_t{SIZE} * (SIZE - 1) / 2);
+        assert(ParallelReduce(pool, v, uint64_t{0}, [](uint64_t a, uint64_t b) {
+                   return std::max(a, b);
+               }) == SIZE - 1);
+        assert(ParallelReduce(pool, Span<uint64_t>(), 42) == 42);
+
+        const Vector<std::string> strings = ParallelTransform(pool, v, [](uint64_t x) {
+            return std::to_string(x);
+        });
+        assert(strings.Size() == SIZE && strings[SIZE - 1] == std::to_string(SIZE - 1));
+    }
+    {
+        Vector<uint32_t> v(SIZE * 3 + 7);
+        uint32_t state = 12345;
+        for (uint32_t& x : v) {
+            state = state * 1103515245 + 12345;
+            x = state >> 8;
+        }
+        Vector<uint32_t> expected(v);
+        std::sort(expected.begin(), expected.end());
+        ParallelSort(pool, v);
+        assert(std::equal(v.begin(), v.end(), expected.begin()));
+
+        ParallelSort(pool, v, std::greater<>());
+        assert(std::is_sorted(v.begin(), v.end(), std::greater<>()));
+    }
+    AtomicObj::ResetCounters();
+    {
+        //        
+        Vector<int> v(SIZE);
+        v[SIZE / 2] = 1;
+        try {
+            ParallelTransform(pool, v, [](int x) {
+                if (x == 1) {
+                    throw std::runtime_error("Oops");
+                }
+                return AtomicObj();
+            });
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(AtomicObj::num_alive == 0);
+    }
+    {
+        //     
+        std::atomic<size_t> sum = 0;
+        pool.ParallelFor(64, [&](size_t i) {
+            if (i < 8) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            sum += i;
+        });
+        assert(sum == 64 * 63 / 2);
+    }
+}
+
+void Test22() {
+    //   ConcurrentVector    
+    assert(detail::FloorLog2(1) == 0 && detail::FloorLog2(2) == 1 && detail::FloorLog2(63) == 5);
+    assert(detail::FloorLog2(size_t{1} << 31) == 31 && detail::FloorLog2(static_cast<size_t>(-1)) == sizeof(size_t) * 8 - 1);
+    {
+        ConcurrentVector<std::string> v;
+        std::string& first = v.EmplaceBack("first");
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(std::to_string(i));
+        }
+        //    
+        assert(&first == &v[0] && v[0] == "first" && v.Size() == 1001 && v[1000] == "999");
+        assert(v.Capacity() >= 1001);
+    }
+    {
+        const size_t NUM_THREADS = 4;
+        const size_t PER_THREAD = 50000;
+        ConcurrentVector<uint64_t> v;
+        std::atomic<bool> done = false;
+        std::atomic<size_t> checked = 0;
+
+        //     
+        std::thread reader([&] {
+            while (!done) {
+                const size_t size = v.Size();
+                for (size_t i = size > 100 ? size - 100 : 0; i < size; ++i) {
+                    assert(v[i] % PER_THREAD < PER_THREAD && v[i] / PER_THREAD < NUM_THREADS);
+                    ++checked;
+                }
+            }
+        });
+
+        std::vector<std::thread> writers;
+        for (size_t t = 0; t < NUM_THREADS; ++t) {
+            writers.emplace_back([&v, t] {
+                for (size_t i = 0; i < PER_THREAD; ++i) {
+                    v.PushBack(t * PER_THREAD + i);
+                }
+            });
+        }
+        for (std::thread& writer : writers) {
+            writer.join();
+        }
+        done = true;
+        reader.join();
+
+        assert(v.Size() == NUM_THREADS * PER_THREAD);
+        std::vector<uint64_t> values;
+        for (size_t i = 0; i < v.Size(); ++i) {
+            values.push_back(v[i]);
+        }
+        std::sort(values.begin(), values.end());
+        for (size_t i = 0; i < values.size(); ++i) {
+            assert(values[i] == i);
+        }
+    }
+    Obj::ResetCounters();
+    {
+        ConcurrentVector<Obj> v;
+        v.Reserve(100);
+        const size_t capacity = v.Capacity();
+        assert(capacity >= 100);
+        v.EmplaceBack(1);
+        v.EmplaceBack(2, "two");
+        //      
+        Obj::default_construction_throw_countdown = 1;
+        try {
+            v.EmplaceBack();
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        v.EmplaceBack(3);
+        assert(v.Size() == 3 && v[2].id == 3 && v.Capacity() == capacity);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test23() {
+    static_assert(detail::DefaultChunkSize<int>() == 16384 && detail::DefaultChunkSize<char[1 << 20]>() == 16);
+    Obj::ResetCounters();
+    {
+        SegmentedVector<Obj, 8> v;
+        Obj& first = v.EmplaceBack(1, "one");
+        for (int i = 2; i <= 100; ++i) {
+            v.EmplaceBack(i);
+        }
+        //       
+        assert(&first == &v[0] && first.name == "one" && v.Size() == 100 && v.Capacity() == 104);
+        assert(Obj::num_moved == 0 && Obj::num_copied == 0);
+
+        //     ,     
+        while (v.Size() < v.Capacity()) {
+            v.PushBack(v[0]);
+        }
+        v.PushBack(v[0]);
+        assert(v[v.Size() - 1].id == 1);
+        v.Resize(100);
+
+        auto it = v.begin();
+        assert(it[42].id == 43 && (it + 99)->id == 100 && v.end() - v.begin() == 100);
+        SegmentedVector<Obj, 8>::const_iterator cit = it + 10;
+        assert(cit->id == 11 && cit > v.cbegin() && v.cend() - cit == 90);
+        std::reverse(v.begin(), v.end());
+        assert(v[0].id == 100 && v[99].id == 1);
+        std::sort(v.begin(), v.end(), [](const Obj& lhs, const Obj& rhs) {
+            return lhs.id < rhs.id;
+        });
+        assert(std::is_sorted(v.begin(), v.end(), [](const Obj& lhs, const Obj& rhs) {
+            return lhs.id < rhs.id;
+        }));
+
+        v.Erase(v.begin());
+        assert(v.Size() == 99 && v[0].id == 2);
+        v.Insert(v.begin() + 5, Obj(-1));
+        assert(v.Size() == 100 && v[5].id == -1 && v[6].id == 7);
+
+        SegmentedVector<Obj, 8> copy(v);
+        assert(copy.Size() == 100 && copy[5].id == -1);
+        SegmentedVector<Obj, 8> moved(std::move(copy));
+        assert(moved.Size() == 100 && copy.Size() == 0);
+        copy = moved;
+        assert(copy.Size() == 100 && copy[99].id == 100);
+
+        v.Resize(10);
+        v.ShrinkToFit();
+        assert(v.Size() == 10 && v.Capacity() == 16);
+        v.Clear();
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        //    ,       
+        SegmentedVector<int, 1> v;
+        const int* first = &v.EmplaceBack(0);
+        for (int i = 1; i < 1000; ++i) {
+            v.PushBack(i);
+            assert(v[i / 2] == i / 2 && v[i] == i);
+        }
+        assert(&v[0] == first && v.Capacity() == 1000);
+        assert(std::accumulate(v.cbegin(), v.cend(), 0) == 999 * 1000 / 2);
+    }
+    {
+        //   :   
+        Obj::default_construction_throw_countdown = 50;
+        try {
+            SegmentedVector<Obj, 16> v(100);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    //     polymorphic_allocator      
+    {
+        std::pmr::unsynchronized_pool_resource pool;
+        using PmrVector = SegmentedVector<std::pmr::string, 4, std::pmr::polymorphic_allocator<std::pmr::string>>;
+        PmrVector lhs{std::pmr::polymorphic_allocator<std::pmr::string>(&pool)};
+        PmrVector rhs;
+        for (int i = 0; i < 10; ++i) {
+            rhs.EmplaceBack("a string that is too long for the small string optimization " + std::to_string(i));
+        }
+        lhs = rhs;
+        assert(lhs.Size() == 10 && lhs[9] == rhs[9] && lhs.GetAllocator().resource() == &pool);
+        assert(lhs[9].get_allocator().resource() == &pool);
+        lhs = std::move(rhs);
+        assert(lhs.Size() == 10 && lhs.GetAllocator().resource() == &pool && lhs[0].get_allocator().resource() == &pool);
+        PmrVector other{std::pmr::polymorphic_allocator<std::pmr::string>(&pool)};
+        other.EmplaceBack("other");
+        lhs.Swap(other);
+        assert(lhs.Size() == 1 && other.Size() == 10 && other[3].get_allocator().resource() == &pool);
+    }
+}
+
+void Test24() {
+    Obj::ResetCounters();
+    {
+        IncrementalVector<Obj, 2> v;
+        v.Reserve(4);
+        for (int i = 0; i < 4; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(!v.IsMigrating() && v.Capacity() == 4);
+
+        //         
+        const int moved_before = Obj::num_moved;
+        v.PushBack(v[0]);
+        assert(v.IsMigrating() && v.Capacity() == 8 && v.Size() == 5);
+        assert(Obj::num_moved - moved_before == 2 && Obj::num_copied == 1);
+        for (size_t i = 0; i < v.Size(); ++i) {
+            assert(v[i].id == (i == 4 ? 0 : static_cast<int>(i)));
+        }
+        v.EmplaceBack(5);
+        assert(!v.IsMigrating() && Obj::num_moved - moved_before == 4);
+
+        //  ,      
+        v.EmplaceBack(6);
+        v.EmplaceBack(7);
+        v.EmplaceBack(8);
+        assert(v.IsMigrating() && v.Size() == 9);
+        for (int i = 0; i < 7; ++i) {
+            v.PopBack();
+        }
+        assert(!v.IsMigrating() && v.Size() == 2 && v[0].id == 0 && v[1].id == 1);
+
+        for (int i = 2; i < 40; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(v.IsMigrating());
+        const IncrementalVector<Obj, 2> copy(v);
+        assert(!copy.IsMigrating() && copy.Size() == 40 && copy.cend() - copy.cbegin() == 40);
+        //             
+        const auto& migrating = v;
+        int expected_id = 0;
+        for (const Obj& obj : migrating) {
+            assert(obj.id == expected_id++);
+        }
+        assert(expected_id == 40 && v.IsMigrating() && (migrating.cbegin() + 39)->id == 39);
+        assert(std::find_if(migrating.begin(), migrating.end(), [](const Obj& obj) {
+                   return obj.id == 17;
+               }) - migrating.begin() == 17);
+        //        
+        for (Obj& obj : v) {
+            obj.id += 100;
+        }
+        IncrementalVector<Obj, 2>::const_iterator first = v.begin();
+        assert(v.IsMigrating() && first->id == 100 && v.end() - v.begin() == 40 && v[39].id == 139);
+        for (auto it = v.begin(); it != v.end(); ++it) {
+            it->id -= 100;
+        }
+        IncrementalVector<Obj, 2> moved(std::move(v));
+        assert(moved.IsMigrating() && v.Size() == 0);
+        moved.FinishMigration();
+        assert(!moved.IsMigrating());
+        int expected = 0;
+        for (const Obj& obj : moved) {
+            assert(obj.id == expected++);
+        }
+        moved.PushBack(Obj(40));
+        assert(moved.Data()[40].id == 40 && !moved.IsMigrating());
+        moved.PushBack(Obj(41));
+        moved = copy;
+        assert(moved.Size() == 40 && moved[39].id == 39);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        //           
+        IncrementalVector<Obj> v;
+        v.EmplaceBack(1);
+        Obj::default_construction_throw_countdown = 1;
+        try {
+            v.EmplaceBack();
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 1 && v.Capacity() == 1 && !v.IsMigrating() && v[0].id == 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    //         
+    {
+        std::pmr::unsynchronized_pool_resource pool;
+        using PmrVector = IncrementalVector<int, 2, std::pmr::polymorphic_allocator<int>>;
+        PmrVector lhs{std::pmr::polymorphic_allocator<int>(&pool)};
+        PmrVector rhs;
+        for (int i = 0; i < 20; ++i) {
+            rhs.PushBack(i);
+        }
+        assert(rhs.IsMigrating());
+        lhs = rhs;
+        assert(lhs.Size() == 20 && lhs[19] == 19 && lhs.GetAllocator().resource() == &pool);
+        lhs.PushBack(20);
+        rhs.PushBack(20);
+        lhs = std::move(rhs);
+        assert(lhs.Size() == 21 && lhs[20] == 20 && lhs.GetAllocator().resource() == &pool);
+        PmrVector moved(std::move(lhs), std::pmr::polymorphic_allocator<int>(&pool));
+        assert(moved.Size() == 21 && lhs.Size() == 0 && moved[5] == 5);
+    }
+    {
+        AllocationStats lhs_stats;
+        AllocationStats rhs_stats;
+        {
+            using CountingVector = IncrementalVector<Obj, 2, CountingAllocator<Obj>>;
+            CountingVector lhs{CountingAllocator<Obj>(&lhs_stats)};
+            CountingVector rhs{CountingAllocator<Obj>(&rhs_stats)};
+            for (int i = 0; i < 10; ++i) {
+                rhs.EmplaceBack(i);
+            }
+            lhs = rhs;
+            lhs = std::move(rhs);
+            assert(lhs.Size() == 10 && lhs[9].id == 9 && lhs.GetAllocator() == CountingAllocator<Obj>(&lhs_stats));
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+        assert(lhs_stats.num_allocations == lhs_stats.num_deallocations);
+        assert(rhs_stats.num_allocations == rhs_stats.num_deallocations);
+    }
+}
+
+void Test25() {
+    Obj::ResetCounters();
+    {
+        SoaVector<float, int, Obj> v;
+        for (int i = 0; i < 10; ++i) {
+            auto ref = v.EmplaceBack(i * 0.5f, i, i);
+            assert(ref.Get<1>() == i && ref.Get<2>().id == i);
+        }
+        assert(v.Size() == 10 && v.Capacity() == 16);
+        //     Obj,  float  int  
+        assert(Obj::num_moved == 1 + 2 + 4 + 8 && Obj::num_copied == 0);
+
+        //     ,   
+        v.Resize(16);
+        v.EmplaceBack(v[3].Get<0>(), v[3].Get<1>(), v[3].Get<2>());
+        assert(v.Size() == 17 && v[16].Get<1>() == 3 && v[16].Get<2>().id == 3);
+        v.Resize(10);
+
+        Span<int> ids = v.Field<1>();
+        assert(ids.Size() == 10 && ids[9] == 9 && &ids[1] == &v[1].Get<1>());
+        for (int& id : ids) {
+            id *= 2;
+        }
+
+        for (auto&& e : v) {
+            e.Get<0>() += 1.0f;
+        }
+        for (auto [x, id, obj] : v) {
+            assert(id == obj.id * 2 && x == obj.id * 0.5f + 1.0f);
+            obj.id = id;
+        }
+        int sum = 0;
+        for (const auto& [x, id, obj] : std::as_const(v)) {
+            sum += obj.id;
+        }
+        assert(sum == 90);
+
+        v[0] = std::tuple<float, int, Obj>(-1.0f, -1, Obj(-1));
+        v[1] = v[2];
+        const std::tuple<float, int, Obj> value = v[1];
+        assert(std::get<1>(value) == 4 && std::get<2>(value).id == 4 && v[0].Get<2>().id == -1);
+
+        const SoaVector<float, int, Obj> copy(v);
+        assert(copy.Size() == 10 && copy[9].Get<2>().id == 18 && copy.Field<0>()[0] == -1.0f);
+        assert(copy.end() - copy.begin() == 10);
+        SoaVector<float, int, Obj> moved(std::move(v));
+        assert(moved.Size() == 10 && v.Size() == 0 && v.Capacity() == 0);
+        v = copy;
+        moved.PopBack();
+        assert(v.Size() == 10 && moved.Size() == 9);
+        moved.PushBack(copy[9]);
+        assert(moved[9].Get<1>() == 18);
+    }
+    {
+        //     ,    
+        SoaVector<int, std::string> v;
+        for (int i = 1; i <= 3; ++i) {
+            v.EmplaceBack(i, std::to_string(i));
+        }
+        auto best = v.begin();
+        for (auto it = v.begin(); it != v.end(); ++it) {
+            assert((*best).Get<0>() <= it->Get<0>());
+            best = it;
+        }
+        assert(v[0].Get<0>() == 1 && v[1].Get<0>() == 2 && v[2].Get<0>() == 3 && v[2].Get<1>() == "3");
+        const auto max = std::max_element(v.begin(), v.end(), [](const auto& lhs, const auto& rhs) {
+            return lhs.template Get<0>() < rhs.template Get<0>();
+        });
+        assert(max - v.begin() == 2 && v[0].Get<0>() == 1 && v[1].Get<1>() == "2");
+
+        auto [number, name] = v[1];
+        number = 20;
+        assert(v[1].Get<0>() == 20 && name == "2");
+    }
+    {
+        //   SoaReference  :      ,
+        //  std::reverse_iterator       
+        SoaVector<int, std::string> v;
+        v.EmplaceBack(1, "1");
+        v.EmplaceBack(2, "2");
+        const auto it = v.begin() + 1;
+        const auto same = std::next(v.begin());
+        assert(it == same && &(*it).Get<0>() == &(*same).Get<0>() && &it->Get<1>() == &v[1].Get<1>());
+
+        const std::reverse_iterator<SoaVector<int, std::string>::iterator> rbegin(v.end());
+        assert((*rbegin).Get<0>() == 2 && rbegin->Get<1>() == "2" && rbegin[1].Get<0>() == 1);
+        std::vector<int> reversed;
+        for (auto rit = rbegin; rit != std::make_reverse_iterator(v.begin()); ++rit) {
+            reversed.push_back(rit->Get<0>());
+        }
+        assert((reversed == std::vector<int>{2, 1}));
+
+        SoaVector<int, std::string>::const_iterator cit;
+        cit = v.end();
+        assert(cit-- == v.cend() && cit == v.cbegin() + 1 && (*cit).Get<1>() == "2");
+#ifdef __cpp_lib_ranges
+        static_assert(std::random_access_iterator<SoaVector<int, std::string>::iterator>);
+        static_assert(std::random_access_iterator<SoaVector<int, std::string>::const_iterator>);
+#endif
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        //          
+        SoaVector<std::string, Obj> v(4);
+        Obj::default_construction_throw_countdown = 3;
+        try {
+            v.Resize(10);
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 6 && v.Capacity() == 10);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test26() {
+    struct alignas(64) Lane {
+        float values[16] = {};
+    };
+    const auto is_aligned = [](const void* p, size_t alignment) {
+        return reinterpret_cast<uintptr_t>(p) % alignment == 0;
+    };
+    {
+        //    alignof(T)
+        Vector<Lane> lanes(3);
+        assert(is_aligned(lanes.Data(), 64));
+        lanes.PushBack(Lane{});
+        assert(is_aligned(lanes.Data(), 64) && lanes.Capacity() == 6);
+    }
+    {
+        AlignedVector<float> v;
+        v.PushBack(1.0f);
+        //    -
+        assert(is_aligned(v.Data(), 64) && v.Capacity() == 16);
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(static_cast<float>(i));
+            assert(is_aligned(v.Data(), 64));
+        }
+        AlignedVector<float> copy(v);
+        assert(is_aligned(copy.Data(), 64) && copy.Size() == 101 && copy[100] == 99.0f);
+
+        AlignedVector<double, 256> wide(5);
+        assert(is_aligned(wide.Data(), 256) && wide.Capacity() == 32);
+        Vector<Lane, AlignedAllocator<Lane, 128>> wide_lanes(7);
+        assert(is_aligned(wide_lanes.Data(), 128) && wide_lanes.Capacity() == 8);
+        static_assert(AlignedAllocator<Lane>::ALIGNMENT == 64 && AlignedAllocator<char, 16>::ALIGNMENT == 16);
+        static_assert(std::allocator_traits<AlignedAllocator<char, 16>>::rebind_alloc<Lane>::ALIGNMENT == 64);
+    }
+    Obj::ResetCounters();
+    {
+        AlignedVector<Obj> v;
+        for (int i = 0; i < 20; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(is_aligned(v.Data(), 64) && v[19].id == 19);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+//       
+template <typename T>
+void CheckSimdOperations(size_t size) {
+    Vector<T> v(size);
+    Vector<T> w(size);
+    for (size_t i = 0; i < size; ++i) {
+        v[i] = static_cast<T>((i * 7) % 23);
+        w[i] = static_cast<T>(i % 3);
+    }
+    const T needle = static_cast<T>(11);
+    assert(simd::Find(v, needle) == static_cast<size_t>(std::find(v.begin(), v.end(), needle) - v.begin()));
+    assert(simd::Count(v, needle) == static_cast<size_t>(std::count(v.begin(), v.end(), needle)));
+    assert(simd::CountIf(v, simd::Less<T>(static_cast<T>(5)))
+           == static_cast<size_t>(std::count_if(v.begin(), v.end(), [](T x) {
+                  return x < static_cast<T>(5);
+              })));
+    assert(simd::FindIf(Span<const T>(v), simd::Greater<T>(static_cast<T>(100))) == size);
+    if (size != 0) {
+        assert(simd::Min(v) == *std::min_element(v.begin(), v.end()));
+        assert(simd::Max(v) == *std::max_element(v.begin(), v.end()));
+    }
+    //  ,         
+    T sum = 0;
+    T dot = 0;
+    for (size_t i = 0; i < size; ++i) {
+        sum += v[i];
+        dot += v[i] * w[i];
+    }
+    assert(simd::Sum(v) == sum && simd::Dot(v, w) == dot);
+
+    Vector<T> result(size);
+    simd::Add(result, v, w);
+    for (size_t i = 0; i < size; ++i) {
+        assert(result[i] == static_cast<T>(v[i] + w[i]));
+    }
+    simd::Mul(result, result, w);
+    for (size_t i = 0; i < size; ++i) {
+        assert(result[i] == static_cast<T>((v[i] + w[i]) * w[i]));
+    }
+
+    std::vector<T> expected;
+    std::copy_if(v.begin(), v.end(), std::back_inserter(expected), [](T x) {
+        return x < static_cast<T>(10);
+    });
+    assert(simd::EraseIf(v, simd::GreaterEqual<T>(static_cast<T>(10))) == size - expected.size());
+    assert(std::equal(v.begin(), v.end(), expected.begin(), expected.end()));
+
+    simd::Fill(Span<T>(w), static_cast<T>(3));
+    assert(std::all_of(w.begin(), w.end(), [](T x) {
+        return x == static_cast<T>(3);
+    }));
+}
+
+void Test27() {
+    const simd::Isa best = simd::ActiveIsa();
+    assert(simd::IsSupported(simd::Isa::Scalar) && simd::IsSupported(best));
+    for (simd::Isa isa : {simd::Isa::Scalar, simd::Isa::Sse42, simd::Isa::Avx2, simd::Isa::Avx512, simd::Isa::Neon}) {
+        if (!simd::IsSupported(isa)) {
+            continue;
+        }
+        simd::SetActiveIsa(isa);
+        for (size_t size : {0, 1, 7, 64, 1000, 40000}) {
+            CheckSimdOperations<int8_t>(size);
+            CheckSimdOperations<uint8_t>(size);
+            CheckSimdOperations<int16_t>(size);
+            CheckSimdOperations<int>(size);
+            CheckSimdOperations<uint64_t>(size);
+            CheckSimdOperations<float>(size);
+            CheckSimdOperations<double>(size);
+        }
+    }
+    simd::SetActiveIsa(best);
+    {
+        //  
+        Vector<float> v(100);
+        simd::Fill(v, 1.0f);
+        v[50] = 2.0f;
+        const Span<const float> tail = Span<const float>(v).Last(97);
+        assert(simd::Find(tail, 2.0f) == 47 && simd::Sum(tail) == 98.0f && simd::Max(tail) == 2.0f);
+    }
+}
+
+void Test28() {
+    Obj::ResetCounters();
+    {
+        Vector<Obj> v;
+        for (int i = 0; i < 10; ++i) {
+            v.EmplaceBack(i);
+        }
+        const int moves_before = Obj::num_move_assigned;
+        assert(v.EraseIf([](const Obj& obj) {
+            return obj.id % 3 == 0;
+        }) == 4);
+        //        
+        assert(v.Size() == 6 && Obj::num_move_assigned - moves_before <= 6);
+        const int expected[] = {1, 2, 4, 5, 7, 8};
+        assert(std::equal(v.begin(), v.end(), std::begin(expected), std::end(expected), [](const Obj& obj, int id) {
+            return obj.id == id;
+        }));
+        assert(Obj::GetAliveObjectCount() == 6);
+
+        //   :     ,  
+        try {
+            v.EraseIf([](const Obj& obj) {
+                if (obj.id == 7) {
+                    throw std::runtime_error("Oops");
+                }
+                return obj.id == 2 || obj.id == 8;
+            });
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 5 && v[0].id == 1 && v[1].id == 4 && v[3].id == 7 && v[4].id == 8);
+        assert(Obj::GetAliveObjectCount() == 5);
+
+        auto it = v.UnorderedErase(v.begin() + 1);
+        assert(v.Size() == 4 && it->id == 8 && v[3].id == 7);
+        it = v.UnorderedErase(v.end() - 1);
+        assert(v.Size() == 3 && it == v.end());
+        assert(Obj::GetAliveObjectCount() == 3);
+
+        for (int i = 0; i < 7; ++i) {
+            v.EmplaceBack(100 + i);
+        }
+        v.EraseIndices(std::vector<size_t>{0, 2, 3, 9});
+        assert(v.Size() == 6 && Obj::GetAliveObjectCount() == 6);
+        int sum = 0;
+        for (const Obj& obj : v) {
+            assert(obj.id != 1 && obj.id != 5 && obj.id != 100 && obj.id != 106);
+            sum += obj.id;
+        }
+        assert(sum == 8 + 101 + 102 + 103 + 104 + 105);
+        v.EraseIndices(Vector<size_t>());
+        assert(v.Size() == 6);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    RelocatableObj::ResetCounters();
+    {
+        //     ,   
+        Vector<RelocatableObj> v;
+        for (int i = 0; i < 100; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(v.EraseIf([](const RelocatableObj& obj) {
+            return *obj.value % 2 == 1;
+        }) == 50);
+        assert(v.Size() == 50 && *v[49].value == 98 && RelocatableObj::num_destroyed == 50);
+        try {
+            v.EraseIf([](const RelocatableObj& obj) {
+                if (*obj.value == 50) {
+                    throw std::runtime_error("Oops");
+                }
+                return *obj.value < 10;
+            });
+            assert(false);
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 45 && *v[0].value == 10 && *v[44].value == 98);
+        v.UnorderedErase(v.begin());
+        v.EraseIndices(std::array<int, 2>{0, 1});
+        assert(v.Size() == 42 && *v[0].value == 94 && *v[1].value == 96 && *v[2].value == 14);
+        assert(RelocatableObj::num_moved == 0 && RelocatableObj::num_destroyed == 58);
+    }
+}
+
+void Test29() {
+    using namespace std::literals;
+
+    //   PopBack   ,     
+    static_assert(noexcept(std::declval<Vector<int>&>().PopBack()));
+    static_assert(noexcept(std::declval<Vector<std::string>&>().Erase({})));
+    static_assert(noexcept(std::declval<Vector<std::string>&>().Erase({}, {})));
+    static_assert(noexcept(std::declval<Vector<std::string>&>().Swap(std::declval<Vector<std::string>&>())));
+    static_assert(noexcept(std::declval<SmallVector<std::string, 4>&>().Erase({})));
+    static_assert(noexcept(std::declval<Vector<int>&>().TryReserve(1)));
+    //      ,     
+    struct ThrowingMoveOnly {
+        ThrowingMoveOnly() = default;
+        ThrowingMoveOnly(ThrowingMoveOnly&&) noexcept(false) {
+        }
+        ThrowingMoveOnly(const ThrowingMoveOnly&) = delete;
+    };
+    static_assert(!noexcept(std::declval<Vector<ThrowingMoveOnly>&>().TryReserve(1)));
+    static_assert(noexcept(std::declval<Vector<std::string>&>().TryReserve(1)));
+    struct ThrowingAssign {
+        ThrowingAssign& operator=(const ThrowingAssign& other) {
+            value = other.value;
+            return *this;
+        }
+        std::string value;
+    };
+    static_assert(!noexcept(std::declval<Vector<ThrowingAssign>&>().Erase({})));
+
+    //      Reserve, EmplaceBack  Resize
+    {
+        Vector<std::string> v;
+        assert(v.TryReserve(10) && v.Capacity() == 10);
+        assert(v.TryEmplaceBack(5, 'a') && v.Size() == 1 && v[0] == "aaaaa"s);
+        assert(v.TryResize(12) && v.Size() == 12 && v.Capacity() >= 12 && v[11].empty());
+        assert(v.TryReserve(1) && v.Capacity() >= 12);
+        assert(!v.TryReserve(static_cast<size_t>(-1) / 2) && v.Size() == 12 && v[0] == "aaaaa"s);
+    }
+    {
+        Vector<int, MallocAllocator<int>> v;
+        for (int i = 0; i < 100; ++i) {
+            assert(v.TryEmplaceBack(i));
+        }
+        assert(v.Size() == 100 && v[99] == 99);
+        assert(!v.TryReserve(static_cast<size_t>(-1) / 2) && v.Size() == 100);
+    }
+    //      
+    {
+        size_t budget = 8;
+        Vector<std::string, LimitedAllocator<std::string>> v{LimitedAllocator<std::string>(&budget)};
+        assert(v.TryReserve(4));
+        for (int i = 0; i < 4; ++i) {
+            assert(v.TryEmplaceBack(std::to_string(i)));
+        }
+        assert(budget == 4);
+        assert(!v.TryEmplaceBack("4"s));
+        assert(!v.TryReserve(5));
+        assert(!v.TryResize(6));
+        assert(v.Size() == 4 && v.Capacity() == 4 && v[3] == "3"s && budget == 4);
+        v.PopBack();
+        v.Erase(v.begin());
+        assert(v.TryEmplaceBack("4"s) && v.Size() == 3 && v[0] == "1"s && v[2] == "4"s);
+        budget = 100;
+        assert(v.TryEmplaceBack("5"s) && v.TryResize(10) && v.Size() == 10 && v[3] == "5"s);
+    }
+}
+
+#if VECTOR_HAS_CONSTEXPR
+//  ,    : Vector , 
+//    std::array,       
+template <size_t N>
+consteval std::array<int, N> MakeSquaresTable() {
+    Vector<int> v;
+    for (int i = static_cast<int>(N) * 2 - 1; i >= 0; --i) {
+        v.PushBack(i * i);
+    }
+    v.EraseIf([](int x) {
+        return x % 2 != 0;
+    });
+    std::reverse(v.begin(), v.end());
+    v.Insert(v.begin(), -1);
+    v.Erase(v.begin());
+    Vector<int> copy = v;
+    copy.ShrinkToFit();
+
+    std::array<int, N> result{};
+    std::copy(copy.begin(), copy.end(), result.begin());
+    return result;
+}
+
+// ,    
+struct ConstexprObj {
+    constexpr ConstexprObj(int value)
+        : value(value) {
+    }
+
+    constexpr ConstexprObj(const ConstexprObj& other)
+        : value(other.value) {
+    }
+
+    constexpr ConstexprObj& operator=(const ConstexprObj& other) {
+        value = other.value;
+        return *this;
+    }
+
+    constexpr ~ConstexprObj() {
+    }
+
+    int value;
+};
+
+constexpr int SumConstexprObjs() {
+    Vector<ConstexprObj> v;
+    for (int i = 0; i < 10; ++i) {
+        v.EmplaceBack(i);
+        v.Emplace(v.begin(), v[v.Size() - 1]);
+    }
+    v.Insert(v.begin() + 3, 4, ConstexprObj(100));
+    v.Erase(v.begin(), v.begin() + 2);
+    v.Erase(v.begin() + 5, v.end());
+    Vector<ConstexprObj> other(v.begin(), v.end());
+    v = std::move(other);
+    int sum = 0;
+    for (const ConstexprObj& obj : v) {
+        sum += obj.value;
+    }
+    return sum;
+}
+#endif
+
+void Test30() {
+#if VECTOR_HAS_CONSTEXPR
+    constexpr std::array<int, 5> squares = MakeSquaresTable<5>();
+    static_assert(squares == std::array<int, 5>{0, 4, 16, 36, 64});
+    //   7, 100, 100, 100, 100
+    static_assert(SumConstexprObjs() == 407);
+
+    // constexpr-     
+    assert(SumConstexprObjs() == 407);
+#endif
+}
+
+void Test31() {
+    using namespace std::literals;
+
+    //       
+    static_assert(std::is_trivially_copyable_v<InplaceVector<int, 8>>);
+    static_assert(!std::is_trivially_copyable_v<InplaceVector<std::string, 8>>);
+    static_assert(sizeof(InplaceVector<uint32_t, 4>) == 4 * sizeof(uint32_t) + sizeof(size_t));
+    {
+        InplaceVector<int, 4> v{1, 2, 3};
+        assert(v.Size() == 3 && v.Capacity() == 4 && v[2] == 3);
+        assert(v.TryPushBack(4) && !v.TryPushBack(5) && !v.TryEmplaceBack(6) && v.Size() == 4);
+        try {
+            v.PushBack(5);
+            assert(false);
+        } catch (const std::bad_alloc&) {
+        }
+        assert(v.Size() == 4 && v[3] == 4);
+
+        InplaceVector<int, 4> copy;
+        std::memcpy(static_cast<void*>(&copy), &v, sizeof(v));
+        assert(copy.Size() == 4 && copy[0] == 1 && copy[3] == 4);
+
+        v.Erase(v.begin() + 1);
+        v.Insert(v.begin(), 0);
+        assert(v.Size() == 4 && v[0] == 0 && v[1] == 1 && v[2] == 3 && v[3] == 4);
+        v.UnorderedErase(v.begin());
+        assert(v.Size() == 3 && v[0] == 4);
+        assert(v.EraseIf([](int x) {
+                   return x % 2 == 1;
+               }) == 2);
+        assert(v.Size() == 1 && v[0] == 4);
+    }
+    //      
+    {
+        Obj::ResetCounters();
+        {
+            InplaceVector<Obj, 5> v(3);
+            assert(Obj::num_default_constructed == 3 && Obj::GetAliveObjectCount() == 3);
+            InplaceVector<Obj, 5> copy(v);
+            assert(Obj::num_copied == 3 && Obj::GetAliveObjectCount() == 6);
+            InplaceVector<Obj, 5> moved(std::move(copy));
+            assert(copy.Size() == 0 && moved.Size() == 3 && Obj::GetAliveObjectCount() == 6);
+            moved.EmplaceBack();
+            moved.Swap(v);
+            assert(v.Size() == 4 && moved.Size() == 3 && Obj::GetAliveObjectCount() == 7);
+            moved = v;
+            assert(moved.Size() == 4 && Obj::GetAliveObjectCount() == 8);
+            v.Resize(1);
+            moved = std::move(v);
+            assert(moved.Size() == 1 && v.Size() == 0 && Obj::GetAliveObjectCount() == 1);
+            try {
+                moved.Resize(6);
+                assert(false);
+            } catch (const std::bad_alloc&) {
+            }
+            assert(moved.Size() == 1);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        InplaceVector<std::string, 3> v;
+        assert(v.TryEmplaceBack(3, 'a') && v.TryPushBack("b"s));
+        v.Emplace(v.begin(), v[1]);
+        assert(v.Size() == 3 && v[0] == "b"s && v[1] == "aaa"s && v[2] == "b"s);
+        assert(!v.TryPushBack("c"s));
+        v.Erase(v.begin(), v.begin() + 2);
+        assert(v.Size() == 1 && v[0] == "b"s);
+        InplaceVector<std::string, 3> other{"x"s, "y"s};
+        v.Swap(other);
+        assert(v.Size() == 2 && v[1] == "y"s && other.Size() == 1 && other[0] == "b"s);
+    }
+}
+
+void Test32() {
+    //   O(1),     
+    {
+        Obj::ResetCounters();
+        {
+            SharedVector<Obj> a(Vector<Obj>(4));
+            SharedVector<Obj> b = a;
+            assert(a.UseCount() == 2 && b.begin() == a.begin() && Obj::num_copied == 0);
+            b.Mutable().Resize(5);
+            assert(a.UseCount() == 1 && b.UseCount() == 1 && b.begin() != a.begin());
+            assert(a.Size() == 4 && b.Size() == 5 && Obj::num_copied == 4);
+            //      
+            const Obj* data = b.begin();
+            b.Mutable()[0].id = 42;
+            assert(b.begin() == data && b[0].id == 42 && Obj::num_copied == 4);
+            a = b;
+            assert(a.UseCount() == 2 && Obj::GetAliveObjectCount() == 5);
+            SharedVector<Obj> c = std::move(a);
+            assert(a.Size() == 0 && a.UseCount() == 0 && c.UseCount() == 2);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        SharedVector<int> v;
+        assert(v.Size() == 0 && v.begin() == v.end());
+        v.PushBack(1);
+        assert(v.Size() == 1 && v[0] == 1 && v.UseCount() == 1);
+    }
+    //    ,     
+    {
+        constexpr int NUM_VERSIONS = 200;
+        constexpr size_t NUM_READERS = 4;
+        PublishedVector<int> table(SharedVector<int>(Vector<int>(100)));
+        std::atomic<bool> done{false};
+        std::atomic<int> num_snapshots{0};
+        std::vector<std::thread> readers;
+        for (size_t i = 0; i < NUM_READERS; ++i) {
+            readers.emplace_back([&] {
+                int last_version = 0;
+                //       ,     
+                do {
+                    const SharedVector<int> snapshot = table.Snapshot();
+                    const int version = snapshot[0];
+                    assert(version >= last_version && snapshot.Size() == 100 + static_cast<size_t>(version));
+                    assert(std::all_of(snapshot.begin(), snapshot.end(), [version](int x) {
+                        return x == version;
+                    }));
+                    last_version = version;
+                    ++num_snapshots;
+                } while (!done.load());
+            });
+        }
+        for (int version = 1; version <= NUM_VERSIONS; ++version) {
+            SharedVector<int> next = table.Snapshot();
+            Vector<int>& data = next.Mutable();
+            std::fill(data.begin(), data.end(), version);
+            data.PushBack(version);
+            table.Publish(std::move(next));
+        }
+        done = true;
+        for (std::thread& reader : readers) {
+            reader.join();
+        }
+        const SharedVector<int> last = table.Snapshot();
+        assert(last.Size() == 100 + NUM_VERSIONS && last[0] == NUM_VERSIONS && last.UseCount() == 2);
+        assert(num_snapshots >= static_cast<int>(NUM_READERS));
+    }
+}
+
+void Test33() {
+    //     :    
+    //  ,       
+    {
+        AllocationStats stats;
+        using IntVector = Vector<int, CountingAllocator<int>>;
+        IntVector source{CountingAllocator<int>(&stats)};
+        source.Assign({1, 2, 3, 4, 5, 6, 7, 8});
+        IntVector destination{CountingAllocator<int>(&stats)};
+        destination.Assign({9, 9});
+        const int allocations = stats.num_allocations;
+
+        destination = source;
+        assert(stats.num_allocations == allocations + 1 && stats.num_deallocations == 1);
+        assert(destination.Size() == 8 && destination.Capacity() == 8 && destination[7] == 8);
+
+        IntVector shorter{CountingAllocator<int>(&stats)};
+        shorter.Assign({5, 4, 3});
+        destination = shorter;
+        assert(destination.Size() == 3 && destination.Capacity() == 8 && destination[0] == 5 && destination[2] == 3);
+        destination = source;
+        assert(destination.Size() == 8 && destination[3] == 4 && stats.num_allocations == allocations + 2);
+        IntVector empty{CountingAllocator<int>(&stats)};
+        destination = empty;
+        assert(destination.Size() == 0 && destination.Capacity() == 8);
+    }
+    //     ,     
+    {
+        Obj::ResetCounters();
+        {
+            Vector<Obj> source(4);
+            Vector<Obj> destination(2);
+            destination = source;
+            assert(destination.Size() == 4 && Obj::num_copied == 4 && Obj::GetAliveObjectCount() == 8);
+            Vector<Obj> shorter(1);
+            Obj::ResetCounters();
+            destination = shorter;
+            assert(destination.Size() == 1 && Obj::num_assigned == 1 && Obj::num_destroyed == 3);
+            destination = source;
+            assert(destination.Size() == 4 && Obj::num_assigned == 2 && Obj::num_copied == 3);
+        }
+    }
+}
+
+void Test34() {
+    // At      , Data()   
+    {
+        Vector<int> v;
+        v.Assign({1, 2, 3});
+        const Vector<int>& cv = v;
+        assert(v.At(2) == 3 && cv.At(0) == 1);
+        v.At(1) = 20;
+        assert(v[1] == 20);
+        bool thrown = false;
+        try {
+            static_cast<void>(cv.At(3));
+        } catch (const std::out_of_range&) {
+            thrown = true;
+        }
+        assert(thrown && v.Size() == 3);
+
+        int* data = v.Data();
+        const int* cdata = cv.Data();
+        assert(data == cdata && data[1] == 20 && &*v.begin() == data);
+        Span<const int> span(cv);
+        assert(span.Data() == data && span.Size() == 3);
+    }
+    //  VECTOR_HARDENING_ITERATORS     Vector  
+#if VECTOR_HARDENING_LEVEL < VECTOR_HARDENING_ITERATORS
+    static_assert(std::is_same_v<Vector<int>::iterator, int*>);
+    static_assert(std::is_same_v<Vector<int>::const_iterator, const int*>);
+    static_assert(sizeof(Vector<int>) == sizeof(RawMemory<int>) + sizeof(size_t));
+#else
+    //        ,    
+    static_assert(!std::is_pointer_v<Vector<int>::iterator>);
+    {
+        Vector<int> v;
+        v.Assign({3, 1, 2});
+        std::sort(v.begin(), v.end());
+        assert(std::is_sorted(v.cbegin(), v.cend()) && v.end() - v.begin() == 3);
+        Vector<int>::const_iterator it = v.begin() + 1;
+        assert(*it == 2 && it[1] == 3 && it < v.cend());
+    }
+    //        ,    
+    //       .      
+    {
+        const auto aborts = [](auto&& use_stale_iterator) {
+            const pid_t pid = fork();
+            if (pid == 0) {
+                use_stale_iterator();
+                _exit(0);
+            }
+            int status = 0;
+            waitpid(pid, &status, 0);
+            return WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+        };
+        {
+            Vector<int> a(2);
+            Vector<int> b(1);
+            a[0] = 10;
+            const auto it = a.begin();
+            a.Swap(b);
+            assert(*it == 10 && it == b.begin());
+            //  a   ,    b
+            a.Reserve(100);
+            assert(*it == 10);
+            Vector<int> c(std::move(b));
+            assert(*it == 10 && it == c.begin());
+            Vector<int> d;
+            d = std::move(c);
+            assert(*it == 10 && it == d.begin());
+        }
+        assert(aborts([] {
+            Vector<int> a(2);
+            Vector<int> b(1);
+            const auto it = a.begin();
+            a.Swap(b);
+            b.Reserve(100);
+            static_cast<void>(*it);
+        }));
+        assert(aborts([] {
+            Vector<int> a(2);
+            Vector<int> c(1);
+            const auto it = c.begin();
+            c = std::move(a);
+            static_cast<void>(*it);
+        }));
+        assert(aborts([] {
+            Vector<int> a(2);
+            const auto it = a.begin();
+            a.Clear();
+            a.Resize(2);
+            static_cast<void>(*it);
+        }));
+        //    :     ,
+        //    ,   
+        assert(aborts([] {
+            Vector<int> c(2);
+            const auto it = c.begin();
+            c = Vector<int>(4);
+            static_cast<void>(*it);
+        }));
+        assert(aborts([] {
+            Vector<int> v(2);
+            const auto it = v.begin();
+            {
+                Vector<int> tmp(4);
+                v.Swap(tmp);
+            }
+            static_cast<void>(*it);
+        }));
+        assert(aborts([] {
+            ThreadPool pool(2);
+            Vector<int> v(2);
+            const Vector<int> source(4);
+            const auto it = v.begin();
+            v.Assign(source, pool);
+            static_cast<void>(*it);
+        }));
+        assert(aborts([] {
+            Vector<int>::iterator it;
+            {
+                Vector<int> v(2);
+                it = v.begin();
+            }
+            static_cast<void>(*it);
+        }));
+        assert(!aborts([] {
+            Vector<int> a(2);
+            const auto it = a.begin();
+            static_cast<void>(*it);
+        }));
+    }
+#endif
+}
+
+void Test35() {
+    //    ASan       
+#if VECTOR_ANNOTATE_CONTAINERS && VECTOR_HAS_ASAN
+    using Int64Vector = Vector<int64_t>;
+    const auto is_annotated = [](const Int64Vector& v) {
+        const int64_t* first = v.Data();
+        return v.Capacity() == 0
+            || __sanitizer_verify_contiguous_container(first, first + v.Size(), first + v.Capacity()) != 0;
+    };
+    {
+        Int64Vector v;
+        v.Reserve(16);
+        assert(is_annotated(v));
+        for (int64_t i = 0; i < 20; ++i) {
+            v.PushBack(i);
+            assert(is_annotated(v));
+        }
+        v.Insert(v.cbegin() + 3, size_t{5}, int64_t{-1});
+        assert(is_annotated(v) && v.Size() == 25);
+        v.Erase(v.cbegin() + 1, v.cbegin() + 10);
+        v.PopBack();
+        v.EraseIf([](int64_t x) {
+            return x % 2 == 0;
+        });
+        assert(is_annotated(v));
+        v.Resize(40);
+        assert(is_annotated(v) && v.Size() == 40);
+        v.Resize(5);
+        v.ShrinkToFit();
+        assert(is_annotated(v) && v.Capacity() == 5);
+        Int64Vector moved(std::move(v));
+        assert(is_annotated(moved));
+        Int64Vector copy(moved);
+        copy.Reserve(10);
+        copy.Assign({1, 2});
+        assert(is_annotated(copy) && copy.Size() == 2 && copy.Capacity() == 10);
+        moved.Clear();
+        assert(is_annotated(moved));
+    }
+    // ,  Release,   
+    {
+        Int64Vector v;
+        v.Reserve(8);
+        v.PushBack(1);
+        const auto released = v.Release();
+        assert(__sanitizer_verify_contiguous_container(released.ptr, released.ptr + released.capacity,
+                                                       released.ptr + released.capacity) != 0);
+        Int64Vector adopted(adopt, released.ptr, released.size, released.capacity);
+        assert(is_annotated(adopted));
+    }
+    //     reallocate  ,    
+    {
+        using ShrinkingVector = Vector<int64_t, FailingReallocAllocator<int64_t>, ShrinkingGrowth<>>;
+        ShrinkingVector v;
+        v.Reserve(16);
+        for (int64_t i = 0; i < 8; ++i) {
+            v.PushBack(i);
+        }
+        FailingReallocAllocator<int64_t>::fail_reallocate = true;
+        v.Resize(2);
+        FailingReallocAllocator<int64_t>::fail_reallocate = false;
+        const int64_t* first = v.Data();
+        assert(v.Size() == 2 && v.Capacity() == 16
+               && __sanitizer_verify_contiguous_container(first, first + 2, first + 16) != 0);
+    }
+    //  Reserve  ,      
+    {
+        size_t budget = 8;
+        Vector<int64_t, LimitedAllocator<int64_t>> v{LimitedAllocator<int64_t>(&budget)};
+        v.Reserve(8);
+        v.PushBack(1);
+        try {
+            v.Reserve(16);
+            assert(false);
+        } catch (const std::bad_alloc&) {
         }
-        Dump();
-    } catch (...) {
+        const int64_t* first = v.Data();
+        assert(v.Size() == 1 && v.Capacity() == 8
+               && __sanitizer_verify_contiguous_container(first, first + 1, first + 8) != 0);
     }
+#endif
 }
 
 int main() {
@@ -648,7 +2870,35 @@ int main() {
         Test4();
         Test5();
         Test6();
-        Benchmark();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+        Test17();
+        Test18();
+        Test19();
+        Test20();
+        Test21();
+        Test22();
+        Test23();
+        Test24();
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
+        Test30();
+        Test31();
+        Test32();
+        Test33();
+        Test34();
+        Test35();
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
     }
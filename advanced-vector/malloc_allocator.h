@@ -0,0 +1,96 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// Остаток блока malloc (malloc_usable_size) используется под элементы, только если задан
+// -DVECTOR_MALLOC_USABLE_SIZE=1. glibc не гарантирует, что в остаток можно писать: проверки
+// _FORTIFY_SOURCE и __builtin_object_size считают размером блока запрошенный, а не реальный
+#ifndef VECTOR_MALLOC_USABLE_SIZE
+#define VECTOR_MALLOC_USABLE_SIZE 0
+#endif
+
+#if VECTOR_MALLOC_USABLE_SIZE && defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "vector.h"
+
+// Аллокатор на основе malloc/free. Помимо стандартного интерфейса предоставляет reallocate,
+// которым Vector пользуется для роста буфера через realloc, если элементы тривиально перемещаемы.
+// Для больших блоков realloc, как правило, расширяет отображение без копирования данных.
+// С VECTOR_MALLOC_USABLE_SIZE allocate_at_least сообщает реальный размер блока (size class)
+template <typename T>
+class MallocAllocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "malloc does not support over-aligned types");
+
+public:
+    using value_type = T;
+
+    MallocAllocator() noexcept = default;
+
+    template <typename U>
+    MallocAllocator(const MallocAllocator<U>& /*other*/) noexcept {
+    }
+
+    T* allocate(size_t n) {
+        if (n > MaxSize()) {
+            VECTOR_THROW(std::bad_array_new_length());
+        }
+        void* p = std::malloc(n * sizeof(T));
+        if (p == nullptr) {
+            VECTOR_THROW(std::bad_alloc());
+        }
+        return static_cast<T*>(p);
+    }
+
+    // Как allocate, но при нехватке памяти возвращает nullptr
+    T* try_allocate(size_t n) noexcept {
+        if (n > MaxSize()) {
+            return nullptr;
+        }
+        return static_cast<T*>(std::malloc(n * sizeof(T)));
+    }
+
+    AllocationResult<T> allocate_at_least(size_t n) {
+        T* p = allocate(n);
+#if VECTOR_MALLOC_USABLE_SIZE && defined(__GLIBC__)
+        return {p, std::max(n, malloc_usable_size(p) / sizeof(T))};
+#else
+        return {p, n};
+#endif
+    }
+
+    void deallocate(T* p, size_t /*n*/) noexcept {
+        std::free(p);
+    }
+
+    // Изменяет размер блока, при необходимости перенося его побайтово на новое место.
+    // При ошибке исходный блок остаётся действительным
+    T* reallocate(T* p, size_t /*old_n*/, size_t new_n) {
+        if (new_n > MaxSize()) {
+            VECTOR_THROW(std::bad_array_new_length());
+        }
+        void* new_p = std::realloc(static_cast<void*>(p), new_n * sizeof(T));
+        if (new_p == nullptr) {
+            VECTOR_THROW(std::bad_alloc());
+        }
+        return static_cast<T*>(new_p);
+    }
+
+    template <typename U>
+    bool operator==(const MallocAllocator<U>& /*other*/) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const MallocAllocator<U>& /*other*/) const noexcept {
+        return false;
+    }
+
+private:
+    static constexpr size_t MaxSize() noexcept {
+        return static_cast<size_t>(-1) / sizeof(T);
+    }
+};
@@ -0,0 +1,320 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#if !defined(__linux__)
+#error "MappedVector requires Linux (mmap, mremap)"
+#endif
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "vector.h"
+
+// Заголовок файла MappedVector. Элементы хранятся сразу за ним
+struct alignas(64) MappedHeader {
+    static constexpr uint64_t MAGIC = 0x524F544345564D41;  // "AMVECTOR"
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    uint64_t magic = MAGIC;
+    uint32_t format_version = FORMAT_VERSION;
+    // Версия схемы данных, назначаемая пользователем
+    uint32_t version = 0;
+    uint64_t type_hash = 0;
+    uint64_t element_size = 0;
+    uint64_t size = 0;
+    uint64_t capacity = 0;
+};
+
+namespace detail {
+
+// Хеш типа элементов: имя типа и его размер. Имя берётся из сигнатуры функции,
+// поэтому хеш совпадает у программ, собранных одним компилятором
+template <typename T>
+uint64_t TypeHash() noexcept {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const char* c = __PRETTY_FUNCTION__; *c != '\0'; ++c) {
+        hash = (hash ^ static_cast<unsigned char>(*c)) * 1099511628211ULL;
+    }
+    return (hash ^ sizeof(T)) * 1099511628211ULL;
+}
+
+}  // namespace detail
+
+// Вектор тривиально копируемых элементов, хранящий их в файле, отображённом в память (mmap).
+// Открытие существующего файла не читает элементы: страницы подгружаются при первом обращении.
+// Размер и ёмкость хранятся в заголовке файла, проверяемом при открытии вместе с хешем типа и версией.
+// Изменения попадают в файл при сбросе страниц ядром; Flush дожидается их записи на диск
+template <typename T, typename GrowthPolicy = DoublingGrowth>
+class MappedVector {
+    static_assert(std::is_trivially_copyable_v<T>, "Elements are stored in the file as bytes");
+    static_assert(alignof(T) <= alignof(MappedHeader), "Over-aligned types are not supported");
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    // Открывает файл path, создавая его при отсутствии. Бросает std::system_error при ошибках
+    // ввода-вывода и std::runtime_error, если файл создан для другого типа или версии
+    explicit MappedVector(const std::string& path, uint32_t version = 0) {
+        fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ == -1) {
+            ThrowSystemError("Failed to open " + path);
+        }
+        try {
+            struct stat st {};
+            if (fstat(fd_, &st) == -1) {
+                ThrowSystemError("Failed to stat " + path);
+            }
+            if (st.st_size == 0) {
+                Create(version);
+            } else {
+                Open(static_cast<size_t>(st.st_size), version);
+            }
+        } catch (...) {
+            Close();
+            throw;
+        }
+    }
+
+    MappedVector(const MappedVector&) = delete;
+    MappedVector& operator=(const MappedVector&) = delete;
+
+    MappedVector(MappedVector&& other) noexcept
+        : fd_(std::exchange(other.fd_, -1))
+        , header_(std::exchange(other.header_, nullptr))
+        , length_(std::exchange(other.length_, 0)) {
+    }
+
+    MappedVector& operator=(MappedVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Close();
+            fd_ = std::exchange(rhs.fd_, -1);
+            header_ = std::exchange(rhs.header_, nullptr);
+            length_ = std::exchange(rhs.length_, 0);
+        }
+        return *this;
+    }
+
+    ~MappedVector() {
+        Close();
+    }
+
+    // Синхронно записывает изменения на диск
+    void Flush() {
+        if (msync(header_, length_, MS_SYNC) == -1) {
+            ThrowSystemError("msync failed");
+        }
+    }
+
+    // Ставит изменения в очередь на запись, не дожидаясь её окончания
+    void FlushAsync() {
+        if (msync(header_, length_, MS_ASYNC) == -1) {
+            ThrowSystemError("msync failed");
+        }
+    }
+
+    uint32_t Version() const noexcept {
+        return header_->version;
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > Capacity()) {
+            Remap(new_capacity);
+        }
+    }
+
+    // Новые элементы инициализируются значением по умолчанию
+    void Resize(size_t new_size) {
+        if (new_size > Size()) {
+            Reserve(new_size);
+            std::uninitialized_value_construct_n(end(), new_size - Size());
+        }
+        header_->size = new_size;
+    }
+
+    void Clear() noexcept {
+        header_->size = 0;
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (Size() == Capacity()) {
+            // Аргументы могут ссылаться на элементы, которые переместятся вместе с отображением
+            T value(std::forward<Args>(args)...);
+            Remap(GrowthPolicy::NextCapacity(Capacity(), Size() + 1, sizeof(T)));
+            return PushValue(value);
+        }
+        T* last = new (end()) T(std::forward<Args>(args)...);
+        ++header_->size;
+        return *last;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PopBack() noexcept {
+        assert(Size() != 0);
+        --header_->size;
+    }
+
+    size_t Size() const noexcept {
+        return header_->size;
+    }
+
+    size_t Capacity() const noexcept {
+        return header_->capacity;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<MappedVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < Size());
+        return begin()[index];
+    }
+
+    iterator begin() noexcept {
+        return reinterpret_cast<T*>(header_ + 1);
+    }
+
+    iterator end() noexcept {
+        return begin() + Size();
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return const_cast<MappedVector&>(*this).begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return cbegin() + Size();
+    }
+
+private:
+    int fd_ = -1;
+    MappedHeader* header_ = nullptr;
+    // Длина отображения, равная длине файла
+    size_t length_ = 0;
+
+    [[noreturn]] static void ThrowSystemError(const std::string& what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    static size_t PageSize() noexcept {
+        static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return page_size;
+    }
+
+    // Длина файла, в котором помещается capacity элементов, кратная размеру страницы
+    static size_t FileLength(size_t capacity) {
+        if (capacity > (SIZE_MAX - sizeof(MappedHeader) - PageSize()) / sizeof(T)) {
+            throw std::length_error("MappedVector is too large");
+        }
+        const size_t page_size = PageSize();
+        return (sizeof(MappedHeader) + capacity * sizeof(T) + page_size - 1) / page_size * page_size;
+    }
+
+    static size_t CapacityOf(size_t length) noexcept {
+        return (length - sizeof(MappedHeader)) / sizeof(T);
+    }
+
+    void Create(uint32_t version) {
+        const size_t length = FileLength(0);
+        if (ftruncate(fd_, static_cast<off_t>(length)) == -1) {
+            ThrowSystemError("ftruncate failed");
+        }
+        Map(length);
+        new (header_) MappedHeader();
+        header_->version = version;
+        header_->type_hash = detail::TypeHash<T>();
+        header_->element_size = sizeof(T);
+        header_->capacity = CapacityOf(length);
+    }
+
+    void Open(size_t length, uint32_t version) {
+        if (length < sizeof(MappedHeader)) {
+            throw std::runtime_error("MappedVector file is truncated");
+        }
+        Map(length);
+        const MappedHeader& header = *header_;
+        if (header.magic != MappedHeader::MAGIC || header.format_version != MappedHeader::FORMAT_VERSION) {
+            throw std::runtime_error("Not a MappedVector file");
+        }
+        if (header.type_hash != detail::TypeHash<T>() || header.element_size != sizeof(T)) {
+            throw std::runtime_error("MappedVector file was created for another element type");
+        }
+        if (header.version != version) {
+            throw std::runtime_error("MappedVector file has another version");
+        }
+        if (header.size > header.capacity || header.capacity > CapacityOf(length)) {
+            throw std::runtime_error("MappedVector file is corrupted");
+        }
+    }
+
+    void Map(size_t length) {
+        void* p = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) {
+            ThrowSystemError("mmap failed");
+        }
+        header_ = static_cast<MappedHeader*>(p);
+        length_ = length;
+    }
+
+    // Увеличивает файл и отображение. Отображение может переместиться, данные при этом не копируются
+    void Remap(size_t new_capacity) {
+        const size_t new_length = FileLength(new_capacity);
+        if (ftruncate(fd_, static_cast<off_t>(new_length)) == -1) {
+            ThrowSystemError("ftruncate failed");
+        }
+        void* p = mremap(header_, length_, new_length, MREMAP_MAYMOVE);
+        if (p == MAP_FAILED) {
+            const int error = errno;
+            // Возвращаем файлу прежнюю длину, чтобы она соответствовала заголовку
+            [[maybe_unused]] const int result = ftruncate(fd_, static_cast<off_t>(length_));
+            errno = error;
+            ThrowSystemError("mremap failed");
+        }
+        header_ = static_cast<MappedHeader*>(p);
+        length_ = new_length;
+        header_->capacity = CapacityOf(new_length);
+    }
+
+    T& PushValue(const T& value) noexcept {
+        T* last = new (end()) T(value);
+        ++header_->size;
+        return *last;
+    }
+
+    void Close() noexcept {
+        if (header_ != nullptr) {
+            munmap(header_, length_);
+            header_ = nullptr;
+        }
+        if (fd_ != -1) {
+            close(fd_);
+            fd_ = -1;
+        }
+    }
+};
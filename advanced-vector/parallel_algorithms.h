@@ -0,0 +1,232 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include "span.h"
+#include "thread_pool.h"
+#include "vector.h"
+
+// Параллельные алгоритмы над непрерывными контейнерами (Vector, SmallVector, MappedVector, Span)
+// и распределение работы для параллельных конструкторов, Assign и Clear вектора. Элементы делятся на части
+// с границами по кэш-линиям (detail::ParallelChunks), и части распределяются между потоками pool.
+// Функции, передаваемые алгоритмам, вызываются одновременно из разных потоков для разных элементов
+
+namespace detail {
+
+// Разбиение массива элементов на части для параллельной обработки. Границы частей проходят
+// по границам кэш-линий, поэтому потоки, записывающие элементы соседних частей, не работают
+// с общими кэш-линиями, если размер элемента делит размер кэш-линии. Части не меньше
+// MIN_CHUNK_BYTES, чтобы распределение работы стоило мало по сравнению с самой работой,
+// а на каждый поток их приходится несколько, чтобы выравнивать нагрузку
+template <typename T>
+class ParallelChunks {
+public:
+    static constexpr size_t MIN_CHUNK_BYTES = size_t{256} << 10;
+
+    ParallelChunks(const T* first, size_t number_elements, size_t concurrency) noexcept
+        : first_address_(reinterpret_cast<uintptr_t>(first))
+        , base_address_(first_address_ / CACHE_LINE_SIZE * CACHE_LINE_SIZE)
+        , number_elements_(number_elements)  //
+    {
+        const size_t bytes = first_address_ - base_address_ + number_elements * sizeof(T);
+        const size_t num_chunks = concurrency * 4;
+        chunk_bytes_ = std::max(MIN_CHUNK_BYTES, (bytes + num_chunks - 1) / num_chunks);
+        chunk_bytes_ = (chunk_bytes_ + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+        count_ = number_elements == 0 ? 0 : (bytes + chunk_bytes_ - 1) / chunk_bytes_;
+    }
+
+    size_t Count() const noexcept {
+        return count_;
+    }
+
+    // Номер первого элемента части index. Begin(Count()) равен числу элементов
+    size_t Begin(size_t index) const noexcept {
+        if (index >= count_) {
+            return number_elements_;
+        }
+        const uintptr_t boundary = base_address_ + index * chunk_bytes_;
+        if (boundary <= first_address_) {
+            return 0;
+        }
+        return std::min(number_elements_, (boundary - first_address_ + sizeof(T) - 1) / sizeof(T));
+    }
+
+    size_t Size(size_t index) const noexcept {
+        return Begin(index + 1) - Begin(index);
+    }
+
+private:
+    uintptr_t first_address_;
+    uintptr_t base_address_;
+    size_t number_elements_;
+    size_t chunk_bytes_ = 0;
+    size_t count_ = 0;
+};
+
+// Конструирует number_elements элементов в потоках pool, вызывая construct(T* chunk_first,
+// size_t chunk_offset, size_t chunk_size) для частей диапазона. Если construct выбрасывает
+// исключение, разрушив элементы своей части, разрушаются и элементы уже сконструированных частей
+template <typename T, typename Allocator, typename Construct>
+void ParallelConstructN(ThreadPool& pool, Allocator& alloc, T* first, size_t number_elements,
+                        Construct&& construct) {
+    const ParallelChunks<T> chunks(first, number_elements, pool.Concurrency());
+    if (chunks.Count() <= 1) {
+        construct(first, 0, number_elements);
+        return;
+    }
+
+    // Каждый флаг записывает только поток, сконструировавший свою часть
+    std::unique_ptr<bool[]> constructed(new bool[chunks.Count()]());
+    VECTOR_TRY {
+        pool.ParallelFor(chunks.Count(), [&](size_t i) {
+            construct(first + chunks.Begin(i), chunks.Begin(i), chunks.Size(i));
+            constructed[i] = true;
+        });
+    } VECTOR_CATCH_ALL {
+        for (size_t i = 0; i < chunks.Count(); ++i) {
+            if (constructed[i]) {
+                ElementOps<T, Allocator>::DestroyN(alloc, first + chunks.Begin(i), chunks.Size(i));
+            }
+        }
+        VECTOR_RETHROW();
+    }
+}
+
+template <typename T, typename Allocator>
+void ParallelDestroyN(ThreadPool& pool, Allocator& alloc, T* first, size_t number_elements) {
+    if constexpr (std::is_trivially_destructible_v<T> && UsesDefaultConstruct<T, Allocator>::value) {
+        return;
+    }
+    const ParallelChunks<T> chunks(first, number_elements, pool.Concurrency());
+    pool.ParallelFor(chunks.Count(), [&](size_t i) {
+        ElementOps<T, Allocator>::DestroyN(alloc, first + chunks.Begin(i), chunks.Size(i));
+    });
+}
+
+// Параллельные операции для конструкторов, Assign и Clear вектора (объявлены в vector.h)
+template <>
+struct ParallelElementOps<ThreadPool> {
+    template <typename T, typename Allocator, typename Construct>
+    static void ConstructN(ThreadPool& pool, Allocator& alloc, T* first, size_t number_elements,
+                           Construct&& construct) {
+        ParallelConstructN(pool, alloc, first, number_elements, std::forward<Construct>(construct));
+    }
+
+    template <typename T, typename Allocator>
+    static void DestroyN(ThreadPool& pool, Allocator& alloc, T* first, size_t number_elements) {
+        ParallelDestroyN(pool, alloc, first, number_elements);
+    }
+};
+
+}  // namespace detail
+
+// Вызывает f(element) для каждого элемента
+template <typename T, typename F>
+void ParallelForEach(ThreadPool& pool, Span<T> elements, F&& f) {
+    const detail::ParallelChunks<T> chunks(elements.Data(), elements.Size(), pool.Concurrency());
+    pool.ParallelFor(chunks.Count(), [&](size_t i) {
+        for (T& element : elements.Subspan(chunks.Begin(i), chunks.Size(i))) {
+            f(element);
+        }
+    });
+}
+
+template <typename Container, typename F>
+void ParallelForEach(ThreadPool& pool, Container& container, F&& f) {
+    ParallelForEach(pool, Span(container), std::forward<F>(f));
+}
+
+// Возвращает вектор результатов f(element). Результаты конструируются сразу в буфере нового вектора;
+// если f или конструктор результата выбрасывает исключение, уже созданные результаты разрушаются
+template <typename T, typename F, typename U = std::decay_t<std::invoke_result_t<F&, T&>>>
+Vector<U> ParallelTransform(ThreadPool& pool, Span<T> elements, F&& f) {
+    using Ops = detail::ElementOps<U, std::allocator<U>>;
+
+    RawMemory<U> memory(elements.Size());
+    detail::ParallelConstructN(pool, memory.GetAllocator(), memory.GetAddress(), elements.Size(),
+                               [&](U* chunk_first, size_t chunk_offset, size_t chunk_size) {
+                                   size_t i = 0;
+                                   VECTOR_TRY {
+                                       for (; i < chunk_size; ++i) {
+                                           Ops::Construct(memory.GetAllocator(), chunk_first + i,
+                                                          f(elements[chunk_offset + i]));
+                                       }
+                                   } VECTOR_CATCH_ALL {
+                                       Ops::DestroyN(memory.GetAllocator(), chunk_first, i);
+                                       VECTOR_RETHROW();
+                                   }
+                               });
+
+    const size_t capacity = memory.Capacity();
+    return Vector<U>(adopt, memory.Release().ptr, elements.Size(), capacity);
+}
+
+template <typename Container, typename F>
+auto ParallelTransform(ThreadPool& pool, Container& container, F&& f) {
+    return ParallelTransform(pool, Span(container), std::forward<F>(f));
+}
+
+// Сворачивает элементы операцией op, которая должна быть ассоциативной: каждая часть
+// сворачивается отдельно, затем к init последовательно применяются результаты частей
+template <typename T, typename R, typename BinaryOp = std::plus<>>
+R ParallelReduce(ThreadPool& pool, Span<T> elements, R init, BinaryOp op = {}) {
+    const detail::ParallelChunks<T> chunks(elements.Data(), elements.Size(), pool.Concurrency());
+    std::unique_ptr<std::optional<R>[]> partial(new std::optional<R>[chunks.Count()]);
+    pool.ParallelFor(chunks.Count(), [&](size_t i) {
+        const Span<T> chunk = elements.Subspan(chunks.Begin(i), chunks.Size(i));
+        if (chunk.Empty()) {
+            return;
+        }
+        R result = chunk[0];
+        for (size_t j = 1; j < chunk.Size(); ++j) {
+            result = op(std::move(result), chunk[j]);
+        }
+        partial[i] = std::move(result);
+    });
+
+    for (size_t i = 0; i < chunks.Count(); ++i) {
+        if (partial[i]) {
+            init = op(std::move(init), std::move(*partial[i]));
+        }
+    }
+    return init;
+}
+
+template <typename Container, typename R, typename BinaryOp = std::plus<>>
+R ParallelReduce(ThreadPool& pool, const Container& container, R init, BinaryOp op = {}) {
+    return ParallelReduce(pool, Span(container), std::move(init), std::move(op));
+}
+
+// Сортирует части параллельно, затем попарно сливает соседние отсортированные последовательности,
+// на каждом шаге удваивая их длину. Сортировка неустойчива
+template <typename T, typename Compare = std::less<>>
+void ParallelSort(ThreadPool& pool, Span<T> elements, Compare comp = {}) {
+    static_assert(!std::is_const_v<T>);
+    const detail::ParallelChunks<T> chunks(elements.Data(), elements.Size(), pool.Concurrency());
+    const size_t num_chunks = chunks.Count();
+    pool.ParallelFor(num_chunks, [&](size_t i) {
+        std::sort(elements.begin() + chunks.Begin(i), elements.begin() + chunks.Begin(i + 1), comp);
+    });
+
+    for (size_t width = 1; width < num_chunks; width *= 2) {
+        const size_t num_merges = (num_chunks + 2 * width - 1) / (2 * width);
+        pool.ParallelFor(num_merges, [&](size_t i) {
+            const size_t first = i * 2 * width;
+            const size_t middle = std::min(first + width, num_chunks);
+            const size_t last = std::min(first + 2 * width, num_chunks);
+            std::inplace_merge(elements.begin() + chunks.Begin(first), elements.begin() + chunks.Begin(middle),
+                               elements.begin() + chunks.Begin(last), comp);
+        });
+    }
+}
+
+template <typename Container, typename Compare = std::less<>>
+void ParallelSort(ThreadPool& pool, Container& container, Compare comp = {}) {
+    ParallelSort(pool, Span(container), std::move(comp));
+}
@@ -0,0 +1,293 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "incremental_vector.h"
+#include "index_iterator.h"
+#include "vector.h"
+
+namespace detail {
+
+// Наибольшая степень двойки, при которой блок занимает не больше 64 КиБ, но не меньше 16 элементов
+template <typename T>
+constexpr size_t DefaultChunkSize() noexcept {
+    size_t chunk_size = 16;
+    while (chunk_size * 2 * sizeof(T) <= (size_t{64} << 10)) {
+        chunk_size *= 2;
+    }
+    return chunk_size;
+}
+
+}  // namespace detail
+
+// Вектор из блоков по ChunkSize элементов, адреса которых хранятся в таблице. Рост добавляет
+// новый блок и никогда не переносит элементы, поэтому PushBack не вызывает пауз на копирование
+// большого массива, а ссылки на элементы остаются действительными до их удаления. Таблица блоков —
+// IncrementalVector, поэтому и при её росте указатели на блоки переносятся понемногу за каждую
+// следующую операцию: PushBack занимает O(1) в худшем случае, не считая времени выделения памяти.
+// Итераторы произвольного доступа ссылаются на сам вектор и не теряют действительности при росте
+template <typename T, size_t ChunkSize = detail::DefaultChunkSize<T>(), typename Allocator = std::allocator<T>>
+class SegmentedVector {
+    static_assert(ChunkSize != 0 && (ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two");
+
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using Ops = detail::ElementOps<T, Allocator>;
+    using Chunk = RawMemory<T, Allocator>;
+    // Таблица растёт вдвое, поэтому перенос по два указателя за добавление блока
+    // завершается до её следующего роста
+    using ChunkTable = IncrementalVector<Chunk, 2>;
+
+public:
+    using value_type = T;
+    using iterator = detail::IndexIterator<SegmentedVector, false>;
+    using const_iterator = detail::IndexIterator<SegmentedVector, true>;
+    using allocator_type = Allocator;
+
+    SegmentedVector() = default;
+
+    explicit SegmentedVector(const Allocator& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    // Делегирующий конструктор завершён до заполнения, поэтому при исключении
+    // уже созданные элементы разрушит деструктор
+    explicit SegmentedVector(size_t size, const Allocator& alloc = Allocator())
+        : SegmentedVector(alloc)  //
+    {
+        Resize(size);
+    }
+
+    SegmentedVector(const SegmentedVector& other)
+        : SegmentedVector(other, AllocTraits::select_on_container_copy_construction(other.alloc_)) {
+    }
+
+    SegmentedVector(const SegmentedVector& other, const Allocator& alloc)
+        : SegmentedVector(alloc)  //
+    {
+        Reserve(other.size_);
+        for (const T& value : other) {
+            EmplaceBack(value);
+        }
+    }
+
+    SegmentedVector(SegmentedVector&& other) noexcept
+        : alloc_(other.alloc_)
+        , chunks_(std::move(other.chunks_))
+        , size_(std::exchange(other.size_, 0)) {
+    }
+
+    // Если аллокаторы не равны, блоки other не могут перейти во владение *this,
+    // поэтому элементы перемещаются поштучно в новые блоки
+    SegmentedVector(SegmentedVector&& other, const Allocator& alloc)
+        : SegmentedVector(alloc)  //
+    {
+        if (alloc_ == other.alloc_) {
+            TakeStorage(other);
+        } else {
+            Reserve(other.size_);
+            for (T& value : other) {
+                EmplaceBack(std::move(value));
+            }
+        }
+    }
+
+    // Копия строится в новых блоках, поэтому при исключении вектор остаётся прежним
+    SegmentedVector& operator=(const SegmentedVector& rhs) {
+        if (this != &rhs) {
+            const bool propagate = AllocTraits::propagate_on_container_copy_assignment::value;
+            SegmentedVector rhs_copy(rhs, propagate ? rhs.alloc_ : alloc_);
+            TakeStorage(rhs_copy);
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                alloc_ = rhs.alloc_;
+            }
+        }
+        return *this;
+    }
+
+    SegmentedVector& operator=(SegmentedVector&& rhs) noexcept(
+        AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value) {
+        if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                TakeStorage(rhs);
+                alloc_ = rhs.alloc_;
+            } else if (AllocTraits::is_always_equal::value || alloc_ == rhs.alloc_) {
+                TakeStorage(rhs);
+            } else {
+                SegmentedVector rhs_moved(std::move(rhs), alloc_);
+                TakeStorage(rhs_moved);
+            }
+        }
+        return *this;
+    }
+
+    ~SegmentedVector() {
+        Clear();
+    }
+
+    // Если аллокаторы не распространяются при обмене, они должны быть равны
+    void Swap(SegmentedVector& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        } else {
+            assert(alloc_ == other.alloc_);
+        }
+        chunks_.Swap(other.chunks_);
+        std::swap(size_, other.size_);
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Выделяет блоки, пока в них не поместится new_capacity элементов
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+        const size_t num_chunks = (new_capacity + ChunkSize - 1) / ChunkSize;
+        chunks_.Reserve(num_chunks);
+        while (chunks_.Size() < num_chunks) {
+            chunks_.EmplaceBack(ChunkSize, alloc_);
+        }
+    }
+
+    void Resize(size_t new_size) {
+        while (size_ > new_size) {
+            PopBack();
+        }
+        Reserve(new_size);
+        while (size_ < new_size) {
+            EmplaceBack();
+        }
+    }
+
+    // Освобождает блоки, не занятые элементами
+    void ShrinkToFit() noexcept {
+        const size_t used_chunks = (size_ + ChunkSize - 1) / ChunkSize;
+        while (chunks_.Size() > used_chunks) {
+            chunks_.PopBack();
+        }
+    }
+
+    void Clear() noexcept {
+        for (size_t i = 0; i * ChunkSize < size_; ++i) {
+            Ops::DestroyN(alloc_, chunks_[i].GetAddress(), std::min(ChunkSize, size_ - i * ChunkSize));
+        }
+        size_ = 0;
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            // Элементы не перемещаются, поэтому args могут ссылаться на элементы вектора
+            chunks_.EmplaceBack(ChunkSize, alloc_);
+        }
+        T* slot = Slot(size_);
+        Ops::Construct(alloc_, slot, std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() noexcept {
+        assert(size_ != 0);
+        --size_;
+        Ops::Destroy(alloc_, Slot(size_));
+    }
+
+    // Вставка и удаление в середине сдвигают последующие элементы и стоят O(Size() - pos)
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args) {
+        assert(cbegin() <= pos && pos <= cend());
+        const size_t offset = pos - cbegin();
+        EmplaceBack(std::forward<Args>(args)...);
+        std::rotate(begin() + offset, end() - 1, end());
+        return begin() + offset;
+    }
+
+    iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    iterator Erase(const_iterator pos) {
+        assert(cbegin() <= pos && pos < cend());
+        const size_t offset = pos - cbegin();
+        std::move(begin() + offset + 1, end(), begin() + offset);
+        PopBack();
+        return begin() + offset;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return chunks_.Size() * ChunkSize;
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SegmentedVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return *Slot(index);
+    }
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+
+    iterator end() noexcept {
+        return {this, size_};
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return {this, 0};
+    }
+
+    const_iterator cend() const noexcept {
+        return {this, size_};
+    }
+
+private:
+    Allocator alloc_;
+    ChunkTable chunks_;
+    size_t size_ = 0;
+
+    // Разрушает элементы *this и забирает блоки и элементы other. Каждый блок хранит аллокатор,
+    // которым выделен, поэтому прежние блоки *this освободит other
+    void TakeStorage(SegmentedVector& other) noexcept {
+        Clear();
+        chunks_.Swap(other.chunks_);
+        size_ = std::exchange(other.size_, 0);
+    }
+
+    T* Slot(size_t index) noexcept {
+        return chunks_[index / ChunkSize].GetAddress() + index % ChunkSize;
+    }
+};
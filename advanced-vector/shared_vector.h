@@ -0,0 +1,224 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "vector.h"
+
+template <typename T, typename Allocator>
+class PublishedVector;
+
+// Вектор с разделяемым буфером и копированием при записи. Копия SharedVector занимает O(1):
+// она лишь увеличивает атомарный счётчик ссылок на общий блок с элементами. Элементы копируются
+// при первом изменении через Mutable, если блок в этот момент разделяют другие копии.
+// Разные объекты SharedVector, в том числе ссылающиеся на один блок, можно читать и изменять
+// из разных потоков без синхронизации; один объект, как и std::shared_ptr, — нет
+template <typename T, typename Allocator = std::allocator<T>>
+class SharedVector {
+public:
+    using value_type = T;
+    using const_iterator = const T*;
+    using allocator_type = Allocator;
+    using VectorType = Vector<T, Allocator>;
+
+    SharedVector() = default;
+
+    explicit SharedVector(VectorType data)
+        : block_(new Block(std::move(data))) {
+    }
+
+    SharedVector(const SharedVector& other) noexcept
+        : block_(other.block_) {
+        AddRef(block_);
+    }
+
+    SharedVector(SharedVector&& other) noexcept
+        : block_(std::exchange(other.block_, nullptr)) {
+    }
+
+    SharedVector& operator=(const SharedVector& rhs) noexcept {
+        if (block_ != rhs.block_) {
+            AddRef(rhs.block_);
+            Release(std::exchange(block_, rhs.block_));
+        }
+        return *this;
+    }
+
+    SharedVector& operator=(SharedVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Release(std::exchange(block_, std::exchange(rhs.block_, nullptr)));
+        }
+        return *this;
+    }
+
+    ~SharedVector() {
+        Release(block_);
+    }
+
+    void Swap(SharedVector& other) noexcept {
+        std::swap(block_, other.block_);
+    }
+
+    // Вектор для изменения. Если блок разделяют другие копии, элементы предварительно
+    // копируются в собственный блок. Ссылки и итераторы, полученные до вызова, могут стать
+    // недействительными
+    VectorType& Mutable() {
+        if (block_ == nullptr) {
+            block_ = new Block(VectorType());
+        } else if (block_->refs.load(std::memory_order_acquire) != 1) {
+            Block* copy = new Block(block_->data);
+            Release(std::exchange(block_, copy));
+        }
+        return block_->data;
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        return Mutable().EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    // Число объектов SharedVector (и PublishedVector), разделяющих блок
+    size_t UseCount() const noexcept {
+        return block_ == nullptr ? 0 : block_->refs.load(std::memory_order_relaxed);
+    }
+
+    size_t Size() const noexcept {
+        return block_ == nullptr ? 0 : block_->data.Size();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        assert(index < Size());
+        return block_->data[index];
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return block_ == nullptr ? nullptr : block_->data.Data();
+    }
+
+    const_iterator cend() const noexcept {
+        return block_ == nullptr ? nullptr : block_->data.Data() + block_->data.Size();
+    }
+
+private:
+    friend class PublishedVector<T, Allocator>;
+
+    struct Block {
+        explicit Block(VectorType&& data)
+            : data(std::move(data)) {
+        }
+
+        explicit Block(const VectorType& data)
+            : data(data) {
+        }
+
+        std::atomic<size_t> refs{1};
+        VectorType data;
+    };
+
+    Block* block_ = nullptr;
+
+    // Принимает во владение ссылку на block
+    explicit SharedVector(Block* block) noexcept
+        : block_(block) {
+    }
+
+    static void AddRef(Block* block) noexcept {
+        if (block != nullptr) {
+            block->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Изменения элементов, сделанные владельцами ссылок, видны потоку, разрушающему блок
+    static void Release(Block* block) noexcept {
+        if (block != nullptr && block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete block;
+        }
+    }
+};
+
+// Ячейка с текущей версией SharedVector в духе RCU. Читатели получают снимок (Snapshot)
+// без блокировок и ожидания писателей: снимок лишь увеличивает счётчик ссылок текущего блока.
+// Писатель строит новую версию в собственной копии и публикует её (Publish); прежняя версия
+// освобождается, когда её отпускает последний снимок. Чтобы блок не освободили между загрузкой
+// указателя и увеличением счётчика ссылок, читатели отмечаются в счётчике своей эпохи,
+// а Publish, сменив эпоху, дожидается завершения уже начатых Snapshot прежней эпохи
+template <typename T, typename Allocator = std::allocator<T>>
+class PublishedVector {
+    using Shared = SharedVector<T, Allocator>;
+    using Block = typename Shared::Block;
+
+public:
+    PublishedVector() = default;
+
+    explicit PublishedVector(Shared initial) noexcept
+        : current_(std::exchange(initial.block_, nullptr)) {
+    }
+
+    PublishedVector(const PublishedVector&) = delete;
+    PublishedVector& operator=(const PublishedVector&) = delete;
+
+    // Вызывается, когда другие потоки уже не обращаются к ячейке
+    ~PublishedVector() {
+        Shared::Release(current_.load(std::memory_order_relaxed));
+    }
+
+    // Текущая версия. Не блокируется; повторяет попытку, только если одновременно сменилась эпоха
+    Shared Snapshot() const noexcept {
+        size_t epoch = epoch_.load();
+        for (;;) {
+            readers_[epoch].fetch_add(1);
+            const size_t current_epoch = epoch_.load();
+            if (current_epoch == epoch) {
+                break;
+            }
+            readers_[epoch].fetch_sub(1);
+            epoch = current_epoch;
+        }
+        Block* block = current_.load();
+        Shared::AddRef(block);
+        readers_[epoch].fetch_sub(1, std::memory_order_release);
+        return Shared(block);
+    }
+
+    // Делает value текущей версией. Публикации выполняются по очереди; каждая ждёт только
+    // читателей, начавших Snapshot до смены эпохи, и не ждёт держателей снимков
+    void Publish(Shared value) {
+        std::lock_guard lock(publish_mutex_);
+        Block* old = current_.exchange(std::exchange(value.block_, nullptr));
+        const size_t epoch = epoch_.load();
+        epoch_.store(epoch ^ 1);
+        // Сохранение эпохи и чтение счётчика, как и увеличение счётчика и чтение эпохи в Snapshot,
+        // должны быть seq_cst: тогда либо читатель увидит новую эпоху, либо Publish увидит читателя
+        while (readers_[epoch].load() != 0) {
+            std::this_thread::yield();
+        }
+        Shared::Release(old);
+    }
+
+private:
+    std::atomic<Block*> current_{nullptr};
+    std::atomic<size_t> epoch_{0};
+    // Число читателей, выполняющих Snapshot в каждой из двух эпох
+    alignas(detail::CACHE_LINE_SIZE) mutable std::atomic<size_t> readers_[2] = {};
+    std::mutex publish_mutex_;
+};
@@ -0,0 +1,631 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+#include "span.h"
+
+// Векторизованные операции над непрерывными массивами арифметических типов (Vector, SmallVector,
+// AlignedVector, Span). Ядра написаны один раз на векторных расширениях GCC/Clang с шириной пакета
+// Bytes и собираются для нескольких наборов инструкций через __attribute__((target)); нужный
+// вариант выбирается при первом вызове по __builtin_cpu_supports (SSE4.2, AVX2, AVX-512) либо
+// во время компиляции (NEON). Скалярный вариант используется на остальных платформах.
+// Векторные типы не пересекают границы функций без атрибута target: все вспомогательные функции
+// встраиваются (always_inline) и принимают пакеты по ссылке, иначе их ABI зависел бы от набора инструкций
+namespace simd {
+
+enum class Isa {
+    Scalar,
+    Sse42,
+    Avx2,
+    Avx512,
+    Neon,
+};
+
+namespace detail {
+
+#define SIMD_INLINE inline __attribute__((always_inline))
+
+template <typename T>
+struct Identity {
+    using type = T;
+};
+
+// Параметр, не участвующий в выводе шаблонного аргумента: Fill(floats, 0) не конфликтует с T = float
+template <typename T>
+using NonDeduced = typename Identity<T>::type;
+
+template <typename T>
+inline constexpr bool IS_VECTORIZABLE = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> && sizeof(T) <= 8;
+
+// Пакет из Bytes / sizeof(T) элементов. Маска сравнения — пакет целых того же размера,
+// элементы которого равны -1 (условие выполнено) или 0
+template <typename T, size_t Bytes>
+struct Batch {
+    static constexpr size_t LANES = Bytes / sizeof(T);
+
+    typedef T Type __attribute__((vector_size(Bytes)));
+    using Mask = decltype(std::declval<Type>() == std::declval<Type>());
+
+    static SIMD_INLINE void Load(const T* p, Type& batch) noexcept {
+        std::memcpy(&batch, p, Bytes);
+    }
+
+    static SIMD_INLINE void Store(T* p, const Type& batch) noexcept {
+        std::memcpy(p, &batch, Bytes);
+    }
+
+    static SIMD_INLINE void Broadcast(T value, Type& batch) noexcept {
+        batch = Type{} + value;
+    }
+
+    static SIMD_INLINE bool Any(const Mask& mask) noexcept {
+        uint64_t words[Bytes / sizeof(uint64_t)];
+        std::memcpy(words, &mask, Bytes);
+        uint64_t any = 0;
+        for (uint64_t word : words) {
+            any |= word;
+        }
+        return any != 0;
+    }
+};
+
+// Целые складываются и умножаются в беззнаковом типе того же размера, чтобы переполнение давало
+// результат по модулю, а не неопределённое поведение. Scalar — тип поэлементных вычислений
+// без целочисленного расширения до int
+template <typename T, typename = void>
+struct Arithmetic {
+    using Lane = T;
+    using Scalar = T;
+};
+
+template <typename T>
+struct Arithmetic<T, std::enable_if_t<std::is_integral_v<T>>> {
+    using Lane = std::make_unsigned_t<T>;
+    using Scalar = decltype(Lane{} + 0u);
+};
+
+// Ядра для пакетов по Bytes байт; при Bytes == 0 остаются только скалярные циклы.
+// Каждое ядро обрабатывает целые пакеты, а остаток массива — поэлементно
+template <size_t Bytes>
+struct Kernels {
+    template <typename T>
+    static SIMD_INLINE void Fill(T* first, size_t n, T value) noexcept {
+        size_t i = 0;
+        if constexpr (Bytes != 0) {
+            using B = Batch<T, Bytes>;
+            typename B::Type batch;
+            B::Broadcast(value, batch);
+            for (; i + B::LANES <= n; i += B::LANES) {
+                B::Store(first + i, batch);
+            }
+        }
+        for (; i < n; ++i) {
+            first[i] = value;
+        }
+    }
+
+    template <typename T, typename Pred>
+    static SIMD_INLINE size_t FindIf(const T* first, size_t n, const Pred& pred) noexcept {
+        size_t i = 0;
+        if constexpr (Bytes != 0) {
+            using B = Batch<T, Bytes>;
+            typename B::Type batch;
+            typename B::Mask mask;
+            for (; i + B::LANES <= n; i += B::LANES) {
+                B::Load(first + i, batch);
+                pred.Mask(batch, mask);
+                if (B::Any(mask)) {
+                    break;
+                }
+            }
+        }
+        for (; i < n; ++i) {
+            if (pred(first[i])) {
+                return i;
+            }
+        }
+        return n;
+    }
+
+    template <typename T, typename Pred>
+    static SIMD_INLINE size_t CountIf(const T* first, size_t n, const Pred& pred) noexcept {
+        size_t count = 0;
+        size_t i = 0;
+        if constexpr (Bytes != 0) {
+            using B = Batch<T, Bytes>;
+            // Счётчики в элементах маски переполнились бы, поэтому сбрасываются каждые MAX_BATCHES пакетов
+            constexpr size_t MAX_BATCHES = 127;
+            typename B::Type batch;
+            typename B::Mask mask;
+            while (i + B::LANES <= n) {
+                typename B::Mask counters{};
+                for (size_t batches = 0; batches < MAX_BATCHES && i + B::LANES <= n; ++batches, i += B::LANES) {
+                    B::Load(first + i, batch);
+                    pred.Mask(batch, mask);
+                    counters -= mask;
+                }
+                for (size_t lane = 0; lane < B::LANES; ++lane) {
+                    count += static_cast<size_t>(counters[lane]);
+                }
+            }
+        }
+        for (; i < n; ++i) {
+            count += pred(first[i]) ? 1 : 0;
+        }
+        return count;
+    }
+
+    template <typename T, bool IsMin>
+    static SIMD_INLINE T MinMax(const T* first, size_t n) noexcept {
+        size_t i = 1;
+        T result = first[0];
+        if constexpr (Bytes != 0) {
+            using B = Batch<T, Bytes>;
+            if (n >= B::LANES) {
+                typename B::Type acc;
+                typename B::Type batch;
+                B::Load(first, acc);
+                for (i = B::LANES; i + B::LANES <= n; i += B::LANES) {
+                    B::Load(first + i, batch);
+                    if constexpr (IsMin) {
+                        acc = batch < acc ? batch : acc;
+                    } else {
+                        acc = batch > acc ? batch : acc;
+                    }
+                }
+                for (size_t lane = 0; lane < B::LANES; ++lane) {
+                    result = (IsMin ? acc[lane] < result : acc[lane] > result) ? acc[lane] : result;
+                }
+            }
+        }
+        for (; i < n; ++i) {
+            result = (IsMin ? first[i] < result : first[i] > result) ? first[i] : result;
+        }
+        return result;
+    }
+
+    // Для Sum second == nullptr
+    template <typename T>
+    static SIMD_INLINE T Dot(const T* first, const T* second, size_t n) noexcept {
+        using L = typename Arithmetic<T>::Lane;
+        using S = typename Arithmetic<T>::Scalar;
+        const L* x_first = reinterpret_cast<const L*>(first);
+        const L* y_first = reinterpret_cast<const L*>(second);
+        S result = 0;
+        size_t i = 0;
+        if constexpr (Bytes != 0) {
+            using B = Batch<L, Bytes>;
+            typename B::Type acc{};
+            typename B::Type x;
+            typename B::Type y;
+            for (; i + B::LANES <= n; i += B::LANES) {
+                B::Load(x_first + i, x);
+                if (y_first != nullptr) {
+                    B::Load(y_first + i, y);
+                    acc += x * y;
+                } else {
+                    acc += x;
+                }
+            }
+            for (size_t lane = 0; lane < B::LANES; ++lane) {
+                result += acc[lane];
+            }
+        }
+        for (; i < n; ++i) {
+            result += y_first != nullptr ? S{x_first[i]} * S{y_first[i]} : S{x_first[i]};
+        }
+        return static_cast<T>(static_cast<L>(result));
+    }
+
+    template <typename T, bool IsAdd>
+    static SIMD_INLINE void Elementwise(T* dst, const T* a, const T* b, size_t n) noexcept {
+        using L = typename Arithmetic<T>::Lane;
+        using S = typename Arithmetic<T>::Scalar;
+        L* dst_first = reinterpret_cast<L*>(dst);
+        const L* a_first = reinterpret_cast<const L*>(a);
+        const L* b_first = reinterpret_cast<const L*>(b);
+        size_t i = 0;
+        if constexpr (Bytes != 0) {
+            using B = Batch<L, Bytes>;
+            typename B::Type x;
+            typename B::Type y;
+            for (; i + B::LANES <= n; i += B::LANES) {
+                B::Load(a_first + i, x);
+                B::Load(b_first + i, y);
+                if constexpr (IsAdd) {
+                    x += y;
+                } else {
+                    x *= y;
+                }
+                B::Store(dst_first + i, x);
+            }
+        }
+        for (; i < n; ++i) {
+            dst_first[i] = static_cast<L>(IsAdd ? S{a_first[i]} + S{b_first[i]} : S{a_first[i]} * S{b_first[i]});
+        }
+    }
+
+    // Сдвигает к началу элементы, не удовлетворяющие pred, и возвращает их число. Пакет без
+    // удаляемых элементов записывается целиком; иначе элементы пакета записываются без ветвлений,
+    // а позиция записи сдвигается только для оставляемых. Запись не опережает чтение
+    template <typename T, typename Pred>
+    static SIMD_INLINE size_t RemoveIf(T* first, size_t n, const Pred& pred) noexcept {
+        size_t kept = 0;
+        size_t i = 0;
+        if constexpr (Bytes != 0) {
+            using B = Batch<T, Bytes>;
+            typename B::Type batch;
+            typename B::Mask mask;
+            for (; i + B::LANES <= n; i += B::LANES) {
+                B::Load(first + i, batch);
+                pred.Mask(batch, mask);
+                if (!B::Any(mask)) {
+                    B::Store(first + kept, batch);
+                    kept += B::LANES;
+                    continue;
+                }
+                for (size_t lane = 0; lane < B::LANES; ++lane) {
+                    first[kept] = batch[lane];
+                    kept += mask[lane] == 0 ? 1 : 0;
+                }
+            }
+        }
+        for (; i < n; ++i) {
+            first[kept] = first[i];
+            kept += pred(first[i]) ? 0 : 1;
+        }
+        return kept;
+    }
+};
+
+// Точки входа ядер, собранные для набора инструкций TARGET
+#define SIMD_DEFINE_TARGET_KERNELS(Name, TARGET, BYTES)                                               \
+    struct Name {                                                                                     \
+        template <typename T>                                                                         \
+        TARGET static void Fill(T* first, size_t n, T value) noexcept {                               \
+            Kernels<BYTES>::Fill(first, n, value);                                                    \
+        }                                                                                             \
+        template <typename T, typename Pred>                                                          \
+        TARGET static size_t FindIf(const T* first, size_t n, const Pred& pred) noexcept {            \
+            return Kernels<BYTES>::FindIf(first, n, pred);                                            \
+        }                                                                                             \
+        template <typename T, typename Pred>                                                          \
+        TARGET static size_t CountIf(const T* first, size_t n, const Pred& pred) noexcept {           \
+            return Kernels<BYTES>::CountIf(first, n, pred);                                           \
+        }                                                                                             \
+        template <typename T, bool IsMin>                                                             \
+        TARGET static T MinMax(const T* first, size_t n) noexcept {                                   \
+            return Kernels<BYTES>::template MinMax<T, IsMin>(first, n);                               \
+        }                                                                                             \
+        template <typename T>                                                                         \
+        TARGET static T Dot(const T* first, const T* second, size_t n) noexcept {                     \
+            return Kernels<BYTES>::Dot(first, second, n);                                             \
+        }                                                                                             \
+        template <typename T, bool IsAdd>                                                             \
+        TARGET static void Elementwise(T* dst, const T* a, const T* b, size_t n) noexcept {           \
+            Kernels<BYTES>::template Elementwise<T, IsAdd>(dst, a, b, n);                             \
+        }                                                                                             \
+        template <typename T, typename Pred>                                                          \
+        TARGET static size_t RemoveIf(T* first, size_t n, const Pred& pred) noexcept {                \
+            return Kernels<BYTES>::RemoveIf(first, n, pred);                                          \
+        }                                                                                             \
+    }
+
+#define SIMD_NO_TARGET
+
+SIMD_DEFINE_TARGET_KERNELS(ScalarKernels, SIMD_NO_TARGET, 0);
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SIMD_HAS_X86_KERNELS 1
+SIMD_DEFINE_TARGET_KERNELS(Sse42Kernels, __attribute__((target("sse4.2"))), 16);
+SIMD_DEFINE_TARGET_KERNELS(Avx2Kernels, __attribute__((target("avx2"))), 32);
+// Сравнение 8- и 16-битных элементов в 512-битных регистрах требует AVX512BW
+SIMD_DEFINE_TARGET_KERNELS(Avx512Kernels, __attribute__((target("avx512f,avx512bw"))), 64);
+#elif defined(__ARM_NEON)
+#define SIMD_HAS_NEON_KERNELS 1
+// NEON входит в базовый набор AArch64, поэтому атрибут target не нужен
+SIMD_DEFINE_TARGET_KERNELS(NeonKernels, SIMD_NO_TARGET, 16);
+#endif
+
+#undef SIMD_NO_TARGET
+#undef SIMD_DEFINE_TARGET_KERNELS
+
+// Наилучший набор инструкций, поддерживаемый процессором
+inline Isa DetectIsa() noexcept {
+#if defined(SIMD_HAS_X86_KERNELS)
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return Isa::Avx512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return Isa::Avx2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return Isa::Sse42;
+    }
+#elif defined(SIMD_HAS_NEON_KERNELS)
+    return Isa::Neon;
+#endif
+    return Isa::Scalar;
+}
+
+inline std::atomic<Isa>& ActiveIsaStorage() noexcept {
+    static std::atomic<Isa> isa{DetectIsa()};
+    return isa;
+}
+
+}  // namespace detail
+
+inline bool IsSupported(Isa isa) noexcept {
+    const Isa best = detail::DetectIsa();
+    switch (isa) {
+        case Isa::Scalar:
+            return true;
+        case Isa::Neon:
+            return best == Isa::Neon;
+        default:
+            // Наборы x86 упорядочены: процессор с AVX-512 поддерживает и AVX2, и SSE4.2
+            return best != Isa::Neon && static_cast<int>(isa) <= static_cast<int>(best);
+    }
+}
+
+// Набор инструкций, которым пользуются операции
+inline Isa ActiveIsa() noexcept {
+    return detail::ActiveIsaStorage().load(std::memory_order_relaxed);
+}
+
+// Переключает операции на isa (для тестов и сравнения вариантов) и возвращает прежний набор
+inline Isa SetActiveIsa(Isa isa) noexcept {
+    assert(IsSupported(isa));
+    return detail::ActiveIsaStorage().exchange(isa, std::memory_order_relaxed);
+}
+
+namespace detail {
+
+// Вызывает f(Kernels{}) с точками входа для текущего набора инструкций
+template <typename F>
+decltype(auto) Dispatch(F&& f) {
+    switch (ActiveIsa()) {
+#if defined(SIMD_HAS_X86_KERNELS)
+        case Isa::Avx512:
+            return f(Avx512Kernels{});
+        case Isa::Avx2:
+            return f(Avx2Kernels{});
+        case Isa::Sse42:
+            return f(Sse42Kernels{});
+#elif defined(SIMD_HAS_NEON_KERNELS)
+        case Isa::Neon:
+            return f(NeonKernels{});
+#endif
+        default:
+            return f(ScalarKernels{});
+    }
+}
+
+template <typename T>
+struct IsSpan : std::false_type {};
+
+template <typename T>
+struct IsSpan<Span<T>> : std::true_type {};
+
+// Перегрузки для контейнеров не принимают Span, иначе вызов с Span, требующий преобразования
+// Span<T> в Span<const T>, выбирал бы перегрузку для контейнеров и зацикливался
+template <typename Container>
+using EnableIfContainer = std::enable_if_t<!IsSpan<std::remove_const_t<Container>>::value>;
+
+template <typename Container>
+using ElementOf = std::remove_reference_t<decltype(*std::declval<Container&>().begin())>;
+
+template <typename T>
+void CheckElementType() noexcept {
+    static_assert(IS_VECTORIZABLE<std::remove_const_t<T>>, "simd operations require arithmetic element types");
+}
+
+}  // namespace detail
+
+// Предикаты сравнения с value для FindIf, CountIf и EraseIf. Помимо обычного вызова
+// предоставляют Mask — то же сравнение сразу для всех элементов пакета
+#define SIMD_DEFINE_COMPARISON(Name, OP)                                     \
+    template <typename T>                                                    \
+    struct Name {                                                            \
+        using value_type = T;                                                \
+                                                                             \
+        explicit Name(T value) noexcept                                      \
+            : value(value) {                                                 \
+        }                                                                    \
+                                                                             \
+        bool operator()(T element) const noexcept {                          \
+            return element OP value;                                         \
+        }                                                                    \
+                                                                             \
+        template <typename B, typename M>                                    \
+        SIMD_INLINE void Mask(const B& batch, M& mask) const noexcept {      \
+            mask = batch OP value;                                           \
+        }                                                                    \
+                                                                             \
+        T value;                                                             \
+    }
+
+SIMD_DEFINE_COMPARISON(Equal, ==);
+SIMD_DEFINE_COMPARISON(NotEqual, !=);
+SIMD_DEFINE_COMPARISON(Less, <);
+SIMD_DEFINE_COMPARISON(LessEqual, <=);
+SIMD_DEFINE_COMPARISON(Greater, >);
+SIMD_DEFINE_COMPARISON(GreaterEqual, >=);
+
+#undef SIMD_DEFINE_COMPARISON
+
+template <typename T>
+void Fill(Span<T> elements, detail::NonDeduced<T> value) noexcept {
+    detail::CheckElementType<T>();
+    detail::Dispatch([&](auto kernels) {
+        kernels.Fill(elements.Data(), elements.Size(), value);
+    });
+}
+
+// Номер первого элемента, удовлетворяющего pred, или Size(), если такого нет
+template <typename T, typename Pred>
+size_t FindIf(Span<T> elements, const Pred& pred) noexcept {
+    detail::CheckElementType<T>();
+    static_assert(std::is_same_v<typename Pred::value_type, std::remove_const_t<T>>);
+    return detail::Dispatch([&](auto kernels) {
+        return kernels.FindIf(elements.Data(), elements.Size(), pred);
+    });
+}
+
+template <typename T>
+size_t Find(Span<T> elements, detail::NonDeduced<std::remove_const_t<T>> value) noexcept {
+    return FindIf(elements, Equal<std::remove_const_t<T>>(value));
+}
+
+template <typename T, typename Pred>
+size_t CountIf(Span<T> elements, const Pred& pred) noexcept {
+    detail::CheckElementType<T>();
+    static_assert(std::is_same_v<typename Pred::value_type, std::remove_const_t<T>>);
+    return detail::Dispatch([&](auto kernels) {
+        return kernels.CountIf(elements.Data(), elements.Size(), pred);
+    });
+}
+
+template <typename T>
+size_t Count(Span<T> elements, detail::NonDeduced<std::remove_const_t<T>> value) noexcept {
+    return CountIf(elements, Equal<std::remove_const_t<T>>(value));
+}
+
+// Массив не должен быть пустым. Если среди элементов есть NaN, результат не определён
+template <typename T>
+std::remove_const_t<T> Min(Span<T> elements) noexcept {
+    detail::CheckElementType<T>();
+    assert(!elements.Empty());
+    return detail::Dispatch([&](auto kernels) {
+        return kernels.template MinMax<std::remove_const_t<T>, true>(elements.Data(), elements.Size());
+    });
+}
+
+template <typename T>
+std::remove_const_t<T> Max(Span<T> elements) noexcept {
+    detail::CheckElementType<T>();
+    assert(!elements.Empty());
+    return detail::Dispatch([&](auto kernels) {
+        return kernels.template MinMax<std::remove_const_t<T>, false>(elements.Data(), elements.Size());
+    });
+}
+
+// Сумма вычисляется в типе T, для целых — по модулю 2^N. Элементы складываются в другом порядке,
+// чем в последовательном цикле, поэтому для чисел с плавающей точкой результат может отличаться
+// в пределах погрешности
+template <typename T>
+std::remove_const_t<T> Sum(Span<T> elements) noexcept {
+    detail::CheckElementType<T>();
+    return detail::Dispatch([&](auto kernels) {
+        return kernels.Dot(elements.Data(), static_cast<const std::remove_const_t<T>*>(nullptr), elements.Size());
+    });
+}
+
+template <typename T, typename U>
+std::remove_const_t<T> Dot(Span<T> lhs, Span<U> rhs) noexcept {
+    detail::CheckElementType<T>();
+    static_assert(std::is_same_v<std::remove_const_t<T>, std::remove_const_t<U>>);
+    assert(lhs.Size() == rhs.Size());
+    return detail::Dispatch([&](auto kernels) {
+        return kernels.Dot(lhs.Data(), rhs.Data(), lhs.Size());
+    });
+}
+
+// dst[i] = a[i] + b[i]. dst может совпадать с a или b, но не перекрываться с ними частично
+template <typename T>
+void Add(Span<T> dst, detail::NonDeduced<Span<const T>> a, detail::NonDeduced<Span<const T>> b) noexcept {
+    detail::CheckElementType<T>();
+    assert(dst.Size() == a.Size() && dst.Size() == b.Size());
+    detail::Dispatch([&](auto kernels) {
+        kernels.template Elementwise<T, true>(dst.Data(), a.Data(), b.Data(), dst.Size());
+    });
+}
+
+// dst[i] = a[i] * b[i]. dst может совпадать с a или b, но не перекрываться с ними частично
+template <typename T>
+void Mul(Span<T> dst, detail::NonDeduced<Span<const T>> a, detail::NonDeduced<Span<const T>> b) noexcept {
+    detail::CheckElementType<T>();
+    assert(dst.Size() == a.Size() && dst.Size() == b.Size());
+    detail::Dispatch([&](auto kernels) {
+        kernels.template Elementwise<T, false>(dst.Data(), a.Data(), b.Data(), dst.Size());
+    });
+}
+
+// Удаляет элементы, удовлетворяющие pred, сохраняя порядок остальных, и возвращает число удалённых
+template <typename Container, typename Pred>
+size_t EraseIf(Container& container, const Pred& pred) {
+    Span elements(container);
+    using T = std::remove_reference_t<decltype(elements[0])>;
+    detail::CheckElementType<T>();
+    static_assert(std::is_same_v<typename Pred::value_type, T>);
+    const size_t kept = detail::Dispatch([&](auto kernels) {
+        return kernels.RemoveIf(elements.Data(), elements.Size(), pred);
+    });
+    container.Erase(container.begin() + kept, container.end());
+    return elements.Size() - kept;
+}
+
+// Перегрузки для контейнеров с непрерывным хранением
+template <typename Container, typename = detail::EnableIfContainer<Container>>
+void Fill(Container& container, const detail::ElementOf<Container>& value) noexcept {
+    Fill(Span(container), value);
+}
+
+template <typename Container, typename Pred, typename = detail::EnableIfContainer<Container>>
+size_t FindIf(const Container& container, const Pred& pred) noexcept {
+    return FindIf(Span(container), pred);
+}
+
+template <typename Container, typename = detail::EnableIfContainer<Container>>
+size_t Find(const Container& container, const detail::ElementOf<Container>& value) noexcept {
+    return Find(Span(container), value);
+}
+
+template <typename Container, typename Pred, typename = detail::EnableIfContainer<Container>>
+size_t CountIf(const Container& container, const Pred& pred) noexcept {
+    return CountIf(Span(container), pred);
+}
+
+template <typename Container, typename = detail::EnableIfContainer<Container>>
+size_t Count(const Container& container, const detail::ElementOf<Container>& value) noexcept {
+    return Count(Span(container), value);
+}
+
+template <typename Container, typename = detail::EnableIfContainer<Container>>
+auto Min(const Container& container) noexcept {
+    return Min(Span(container));
+}
+
+template <typename Container, typename = detail::EnableIfContainer<Container>>
+auto Max(const Container& container) noexcept {
+    return Max(Span(container));
+}
+
+template <typename Container, typename = detail::EnableIfContainer<Container>>
+auto Sum(const Container& container) noexcept {
+    return Sum(Span(container));
+}
+
+template <typename Container, typename = detail::EnableIfContainer<Container>>
+auto Dot(const Container& lhs, const Container& rhs) noexcept {
+    return Dot(Span(lhs), Span(rhs));
+}
+
+template <typename Container, typename = detail::EnableIfContainer<Container>>
+void Add(Container& dst, const Container& a, const Container& b) noexcept {
+    Add(Span(dst), Span(a), Span(b));
+}
+
+template <typename Container, typename = detail::EnableIfContainer<Container>>
+void Mul(Container& dst, const Container& a, const Container& b) noexcept {
+    Mul(Span(dst), Span(a), Span(b));
+}
+
+}  // namespace simd
+
+#undef SIMD_INLINE
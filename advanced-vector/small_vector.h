@@ -0,0 +1,264 @@
+#pragma once
+#include "vector.h"
+
+// Вектор, хранящий до N элементов внутри себя и переходящий в динамическую память (RawMemory)
+// при дальнейшем росте. Вставка, удаление и перенос элементов выполняются теми же операциями,
+// что и в Vector, поэтому гарантии безопасности исключений у них совпадают
+template <typename T, size_t N, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth>
+class SmallVector {
+    static_assert(N > 0, "Use Vector if no inline storage is needed");
+
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using Ops = detail::ElementOps<T, Allocator>;
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+    using allocator_type = Allocator;
+
+    SmallVector() = default;
+
+    explicit SmallVector(const Allocator& alloc) noexcept
+        : heap_(alloc) {
+    }
+
+    explicit SmallVector(size_t size, const Allocator& alloc = Allocator())
+        : heap_(size > N ? size : 0, alloc)  //
+    {
+        Ops::UninitializedValueConstructN(heap_.GetAllocator(), begin(), size);
+        size_ = size;
+    }
+
+    SmallVector(const SmallVector& other)
+        : heap_(other.size_ > N ? other.size_ : 0,
+                AllocTraits::select_on_container_copy_construction(other.heap_.GetAllocator()))  //
+    {
+        Ops::UninitializedCopyN(heap_.GetAllocator(), other.begin(), other.size_, begin());
+        size_ = other.size_;
+    }
+
+    // Элементы из встроенного буфера other перемещаются поштучно, динамический буфер забирается целиком
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : heap_(other.heap_.GetAllocator())  //
+    {
+        if (other.IsInline()) {
+            Ops::UninitializedMoveN(heap_.GetAllocator(), other.begin(), other.size_, begin());
+            size_ = other.size_;
+            other.Clear();
+        } else {
+            heap_ = std::move(other.heap_);
+            size_ = std::exchange(other.size_, 0);
+        }
+    }
+
+    SmallVector& operator=(const SmallVector& rhs) {
+        if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                if (heap_.GetAllocator() != rhs.heap_.GetAllocator()) {
+                    // Элементы и память должны быть освобождены прежним аллокатором
+                    Clear();
+                }
+                heap_.AssignAllocator(rhs.heap_.GetAllocator());
+            }
+
+            if (rhs.size_ > Capacity()) {
+                // Копия строится в новом буфере собственным аллокатором, поэтому при исключении
+                // вектор остаётся прежним
+                RawMemory<T, Allocator> new_data(rhs.size_, heap_.GetAllocator());
+                Ops::UninitializedCopyN(heap_.GetAllocator(), rhs.begin(), rhs.size_, new_data.GetAddress());
+                Ops::DestroyN(heap_.GetAllocator(), begin(), size_);
+                heap_.Swap(new_data);
+            } else {
+                Ops::AssignN(heap_.GetAllocator(), rhs.begin(), rhs.size_, begin(), size_);
+            }
+            size_ = rhs.size_;
+        }
+        return *this;
+    }
+
+    // Аллокаторы *this и rhs должны быть равны
+    SmallVector& operator=(SmallVector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (this != &rhs) {
+            assert(heap_.GetAllocator() == rhs.heap_.GetAllocator());
+            Clear();
+            if (rhs.IsInline()) {
+                // Собственный динамический буфер, если он есть, переиспользуется
+                Ops::UninitializedMoveN(heap_.GetAllocator(), rhs.begin(), rhs.size_, begin());
+                size_ = rhs.size_;
+                rhs.Clear();
+            } else {
+                heap_ = std::move(rhs.heap_);
+                size_ = std::exchange(rhs.size_, 0);
+            }
+        }
+        return *this;
+    }
+
+    ~SmallVector() {
+        Ops::DestroyN(heap_.GetAllocator(), begin(), size_);
+    }
+
+    void Swap(SmallVector& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        if (!IsInline() && !other.IsInline()) {
+            heap_.Swap(other.heap_);
+            std::swap(size_, other.size_);
+        } else {
+            SmallVector tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+    }
+
+    allocator_type GetAllocator() const noexcept {
+        return heap_.GetAllocator();
+    }
+
+    // Элементы хранятся во встроенном буфере
+    bool IsInline() const noexcept {
+        return heap_.GetAddress() == nullptr;
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+
+        if (!IsInline() && Ops::GrowInPlace(heap_, new_capacity)) {
+            return;
+        }
+
+        RawMemory<T, Allocator> new_data(new_capacity, heap_.GetAllocator());
+        Ops::TransferN(heap_.GetAllocator(), begin(), size_, new_data.GetAddress());
+        heap_.Swap(new_data);
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            Ops::DestroyN(heap_.GetAllocator(), begin() + new_size, size_ - new_size);
+
+        } else if (new_size > size_) {
+            Reserve(new_size);
+            Ops::UninitializedValueConstructN(heap_.GetAllocator(), begin() + size_, new_size - size_);
+        }
+
+        size_ = new_size;
+    }
+
+    void Clear() noexcept {
+        Ops::DestroyN(heap_.GetAllocator(), begin(), size_);
+        size_ = 0;
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        return *Emplace(cend(), std::forward<Args>(args)...);
+    }
+
+    void PushBack(const T& value) {
+        EmplaceBack(value);
+    }
+
+    void PushBack(T&& value) {
+        EmplaceBack(std::move(value));
+    }
+
+    void PopBack() noexcept {
+        assert(size_ != 0);
+        --size_;
+        Ops::Destroy(heap_.GetAllocator(), end());
+    }
+
+    iterator Erase(const_iterator pos) noexcept(Ops::NOTHROW_ERASE) {
+        assert(begin() <= pos && pos < end() && size_ != 0);
+        size_t offset = pos - cbegin();
+        Ops::Erase(heap_.GetAllocator(), begin(), size_, offset);
+        --size_;
+
+        return begin() + offset;
+    }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator pos, Args&&... args) {
+        assert(begin() <= pos && pos <= end());
+        size_t new_item_offset = std::distance(cbegin(), pos);
+
+        if (size_ == Capacity()) {
+            EmplaceWithAllocation(new_item_offset, std::forward<Args>(args)...);
+        } else {
+            Ops::EmplaceInPlace(heap_.GetAllocator(), begin(), size_, new_item_offset, std::forward<Args>(args)...);
+        }
+
+        ++size_;
+        return begin() + new_item_offset;
+    }
+
+    iterator Insert(const_iterator pos, const T& value) {
+        return Emplace(pos, value);
+    }
+
+    iterator Insert(const_iterator pos, T&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return IsInline() ? N : heap_.Capacity();
+    }
+
+    const T& operator[](size_t index) const noexcept {
+        return const_cast<SmallVector&>(*this)[index];
+    }
+
+    T& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return begin()[index];
+    }
+
+    iterator begin() noexcept {
+        return IsInline() ? reinterpret_cast<T*>(inline_buffer_) : heap_.GetAddress();
+    }
+
+    iterator end() noexcept {
+        return begin() + size_;
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return const_cast<SmallVector&>(*this).begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return cbegin() + size_;
+    }
+
+private:
+    RawMemory<T, Allocator> heap_;
+    size_t size_ = 0;
+    alignas(T) unsigned char inline_buffer_[N * sizeof(T)];
+
+    template <typename... Args>
+    void EmplaceWithAllocation(size_t new_item_offset, Args&&... args) {
+        size_t new_capacity = GrowthPolicy::NextCapacity(Capacity(), size_ + 1, sizeof(T));
+
+        if (!IsInline()
+            && Ops::EmplaceGrowingInPlace(heap_, size_, new_item_offset, new_capacity, std::forward<Args>(args)...)) {
+            return;
+        }
+
+        RawMemory<T, Allocator> new_data(new_capacity, heap_.GetAllocator());
+        Ops::EmplaceRelocating(heap_.GetAllocator(), begin(), size_, new_item_offset, new_data.GetAddress(),
+                               std::forward<Args>(args)...);
+        heap_.Swap(new_data);
+    }
+};
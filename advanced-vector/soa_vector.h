@@ -0,0 +1,422 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "index_iterator.h"
+#include "span.h"
+#include "vector.h"
+
+// Ссылка на элемент SoaVector: указатели на поля элемента в буферах полей. Присваивание
+// изменяет поля элемента, а не саму ссылку. Поддерживает структурное связывание:
+// auto [position, velocity] = v[i];
+template <typename... Fields>
+class SoaReference {
+public:
+    using value_type = std::tuple<std::remove_const_t<Fields>...>;
+
+    explicit SoaReference(Fields*... fields) noexcept
+        : fields_(fields...) {
+    }
+
+    SoaReference(const SoaReference&) noexcept = default;
+
+    // Ссылка на изменяемый элемент приводится к ссылке на константный
+    template <typename... Others,
+              typename = std::enable_if_t<(std::is_convertible_v<Others*, Fields*> && ...)>>
+    SoaReference(const SoaReference<Others...>& other) noexcept
+        : fields_(other.fields_) {
+    }
+
+    SoaReference& operator=(const SoaReference& other) {
+        Assign(other, std::index_sequence_for<Fields...>{});
+        return *this;
+    }
+
+    SoaReference& operator=(const value_type& value) {
+        Assign(value, std::index_sequence_for<Fields...>{});
+        return *this;
+    }
+
+    template <size_t I>
+    auto& Get() const noexcept {
+        return *std::get<I>(fields_);
+    }
+
+    operator value_type() const {
+        return std::apply(
+            [](const auto*... fields) {
+                return value_type(*fields...);
+            },
+            fields_);
+    }
+
+    template <size_t I>
+    friend auto& get(const SoaReference& ref) noexcept {
+        return ref.Get<I>();
+    }
+
+private:
+    template <typename...>
+    friend class SoaReference;
+    template <typename...>
+    friend class SoaVector;
+
+    std::tuple<Fields*...> fields_;
+
+    template <typename Source, size_t... I>
+    void Assign(const Source& source, std::index_sequence<I...>) {
+        using std::get;
+        ((*std::get<I>(fields_) = get<I>(source)), ...);
+    }
+};
+
+namespace std {
+
+template <typename... Fields>
+struct tuple_size<SoaReference<Fields...>> : integral_constant<size_t, sizeof...(Fields)> {};
+
+template <size_t I, typename... Fields>
+struct tuple_element<I, SoaReference<Fields...>> {
+    using type = tuple_element_t<I, tuple<Fields...>>;
+};
+
+}  // namespace std
+
+// Вектор записей, поля которых хранятся в отдельных буферах (structure of arrays): цикл,
+// которому нужны два поля из восьми, читает из памяти только эти два массива. Все буферы имеют
+// общие размер и ёмкость и растут вместе. Field<I>() возвращает Span поля для векторизуемых
+// циклов; operator[] и итераторы возвращают SoaReference по значению, поэтому элементы обходят циклом
+// for (auto&& e : v) или for (auto e : v), а изменение e изменяет поля элемента
+template <typename... Fields>
+class SoaVector {
+    static_assert(sizeof...(Fields) > 0);
+    static_assert((!std::is_const_v<Fields> && ...) && (!std::is_reference_v<Fields> && ...));
+
+    static constexpr size_t NUM_FIELDS = sizeof...(Fields);
+
+    template <size_t I>
+    using FieldType = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    template <size_t I>
+    using FieldOps = detail::ElementOps<FieldType<I>, std::allocator<FieldType<I>>>;
+
+    using Storage = std::tuple<RawMemory<Fields>...>;
+
+public:
+    using value_type = std::tuple<Fields...>;
+    using reference = SoaReference<Fields...>;
+    using const_reference = SoaReference<const Fields...>;
+    using iterator = detail::IndexIterator<SoaVector, false>;
+    using const_iterator = detail::IndexIterator<SoaVector, true>;
+
+    SoaVector() = default;
+
+    explicit SoaVector(size_t size)
+        : SoaVector()  //
+    {
+        Resize(size);
+    }
+
+    SoaVector(const SoaVector& other)
+        : SoaVector()  //
+    {
+        Reserve(other.size_);
+        for (size_t i = 0; i < other.size_; ++i) {
+            PushBack(other[i]);
+        }
+    }
+
+    SoaVector(SoaVector&& other) noexcept
+        : data_(std::move(other.data_))
+        , size_(std::exchange(other.size_, 0))
+        , capacity_(std::exchange(other.capacity_, 0)) {
+    }
+
+    SoaVector& operator=(const SoaVector& rhs) {
+        if (this != &rhs) {
+            SoaVector rhs_copy(rhs);
+            Swap(rhs_copy);
+        }
+        return *this;
+    }
+
+    SoaVector& operator=(SoaVector&& rhs) noexcept {
+        if (this != &rhs) {
+            SoaVector rhs_moved(std::move(rhs));
+            Swap(rhs_moved);
+        }
+        return *this;
+    }
+
+    ~SoaVector() {
+        Clear();
+    }
+
+    void Swap(SoaVector& other) noexcept {
+        ForEachField([&](auto field) {
+            Memory<field>(data_).Swap(Memory<field>(other.data_));
+        });
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    // Выделяет буферы всех полей разом. Если перенос поля выбрасывает исключение, вектор не изменяется
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= capacity_) {
+            return;
+        }
+        Storage new_data = Allocate(new_capacity);
+        TransferTo(new_data);
+        Replace(new_data, new_capacity);
+    }
+
+    void Resize(size_t new_size) {
+        while (size_ > new_size) {
+            PopBack();
+        }
+        Reserve(new_size);
+        while (size_ < new_size) {
+            EmplaceBack();
+        }
+    }
+
+    void Clear() noexcept {
+        ForEachField([&](auto field) {
+            FieldOps<field>::DestroyN(Memory<field>(data_).GetAllocator(), Memory<field>(data_).GetAddress(), size_);
+        });
+        size_ = 0;
+    }
+
+    // Принимает по одному аргументу на каждое поле либо ни одного, тогда поля инициализируются по умолчанию
+    template <typename... Args>
+    reference EmplaceBack(Args&&... args) {
+        static_assert(sizeof...(Args) == NUM_FIELDS || sizeof...(Args) == 0);
+        if (size_ == capacity_) {
+            const size_t new_capacity = DoublingGrowth::NextCapacity(capacity_, size_ + 1, SizeOfRecord());
+            Storage new_data = Allocate(new_capacity);
+            // Аргументы могут ссылаться на поля элементов, поэтому новый элемент конструируется до переноса
+            ConstructAt(new_data, size_, std::forward<Args>(args)...);
+            VECTOR_TRY {
+                TransferTo(new_data);
+            } VECTOR_CATCH_ALL {
+                DestroyAt(new_data, size_);
+                VECTOR_RETHROW();
+            }
+            Replace(new_data, new_capacity);
+        } else {
+            ConstructAt(data_, size_, std::forward<Args>(args)...);
+        }
+        ++size_;
+        return (*this)[size_ - 1];
+    }
+
+    void PushBack(const value_type& value) {
+        std::apply(
+            [this](const auto&... fields) {
+                EmplaceBack(fields...);
+            },
+            value);
+    }
+
+    void PushBack(value_type&& value) {
+        std::apply(
+            [this](auto&... fields) {
+                EmplaceBack(std::move(fields)...);
+            },
+            value);
+    }
+
+    template <typename... Others>
+    void PushBack(const SoaReference<Others...>& ref) {
+        std::apply(
+            [this](const auto*... fields) {
+                EmplaceBack(*fields...);
+            },
+            ref.fields_);
+    }
+
+    void PopBack() noexcept {
+        assert(size_ != 0);
+        --size_;
+        DestroyAt(data_, size_);
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept {
+        return capacity_;
+    }
+
+    // Непрерывный массив значений поля I
+    template <size_t I>
+    Span<FieldType<I>> Field() noexcept {
+        return {Memory<I>(data_).GetAddress(), size_};
+    }
+
+    template <size_t I>
+    Span<const FieldType<I>> Field() const noexcept {
+        return {Memory<I>(data_).GetAddress(), size_};
+    }
+
+    reference operator[](size_t index) noexcept {
+        assert(index < size_);
+        return ReferenceAt(index);
+    }
+
+    const_reference operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return const_cast<SoaVector&>(*this).ReferenceAt(index);
+    }
+
+    iterator begin() noexcept {
+        return {this, 0};
+    }
+
+    iterator end() noexcept {
+        return {this, size_};
+    }
+
+    const_iterator begin() const noexcept {
+        return cbegin();
+    }
+
+    const_iterator end() const noexcept {
+        return cend();
+    }
+
+    const_iterator cbegin() const noexcept {
+        return {this, 0};
+    }
+
+    const_iterator cend() const noexcept {
+        return {this, size_};
+    }
+
+private:
+    Storage data_;
+    size_t size_ = 0;
+    // Ёмкость каждого из буферов
+    size_t capacity_ = 0;
+
+    // Буферы всех полей выделяются до переноса, поэтому нехватка памяти не изменяет вектор
+    static Storage Allocate(size_t capacity) {
+        return Storage(RawMemory<Fields>(capacity)...);
+    }
+
+    static constexpr size_t SizeOfRecord() noexcept {
+        return (sizeof(Fields) + ...);
+    }
+
+    template <size_t I>
+    static RawMemory<FieldType<I>>& Memory(Storage& storage) noexcept {
+        return std::get<I>(storage);
+    }
+
+    template <size_t I>
+    static const RawMemory<FieldType<I>>& Memory(const Storage& storage) noexcept {
+        return std::get<I>(storage);
+    }
+
+    // Вызывает f(std::integral_constant<size_t, I>{}) для полей по порядку
+    template <typename F>
+    static void ForEachField(F&& f) {
+        ForEachField(f, std::index_sequence_for<Fields...>{});
+    }
+
+    template <typename F, size_t... I>
+    static void ForEachField(F& f, std::index_sequence<I...>) {
+        (f(std::integral_constant<size_t, I>{}), ...);
+    }
+
+    reference ReferenceAt(size_t index) noexcept {
+        return std::apply(
+            [index](auto&... memory) {
+                return reference(memory + index...);
+            },
+            data_);
+    }
+
+    // Конструирует поля элемента index по порядку; при исключении созданные поля разрушаются
+    template <typename... Args>
+    static void ConstructAt(Storage& storage, size_t index, Args&&... args) {
+        auto args_tuple = std::forward_as_tuple(std::forward<Args>(args)...);
+        size_t constructed = 0;
+        VECTOR_TRY {
+            ForEachField([&](auto field) {
+                auto& memory = Memory<field>(storage);
+                if constexpr (sizeof...(Args) == 0) {
+                    FieldOps<field>::Construct(memory.GetAllocator(), memory + index);
+                } else {
+                    FieldOps<field>::Construct(memory.GetAllocator(), memory + index,
+                                               std::get<field>(std::move(args_tuple)));
+                }
+                ++constructed;
+            });
+        } VECTOR_CATCH_ALL {
+            ForEachField([&](auto field) {
+                if (field < constructed) {
+                    auto& memory = Memory<field>(storage);
+                    FieldOps<field>::Destroy(memory.GetAllocator(), memory + index);
+                }
+            });
+            VECTOR_RETHROW();
+        }
+    }
+
+    static void DestroyAt(Storage& storage, size_t index) noexcept {
+        ForEachField([&](auto field) {
+            auto& memory = Memory<field>(storage);
+            FieldOps<field>::Destroy(memory.GetAllocator(), memory + index);
+        });
+    }
+
+    // Переносит элементы в new_data. Поля, которые приходится копировать, переносятся первыми:
+    // если копирование выбрасывает исключение, старые буферы ещё не изменены.
+    // Остальные поля переносятся без исключений
+    void TransferTo(Storage& new_data) {
+        size_t copied = 0;
+        VECTOR_TRY {
+            ForEachField([&](auto field) {
+                if constexpr (FieldOps<field>::TRANSFER_COPIES) {
+                    auto& memory = Memory<field>(new_data);
+                    FieldOps<field>::UninitializedCopyN(memory.GetAllocator(), Memory<field>(data_).GetAddress(), size_,
+                                                        memory.GetAddress());
+                }
+                ++copied;
+            });
+        } VECTOR_CATCH_ALL {
+            ForEachField([&](auto field) {
+                if constexpr (FieldOps<field>::TRANSFER_COPIES) {
+                    if (field < copied) {
+                        auto& memory = Memory<field>(new_data);
+                        FieldOps<field>::DestroyN(memory.GetAllocator(), memory.GetAddress(), size_);
+                    }
+                }
+            });
+            VECTOR_RETHROW();
+        }
+
+        ForEachField([&](auto field) {
+            auto& memory = Memory<field>(data_);
+            if constexpr (FieldOps<field>::TRANSFER_COPIES) {
+                FieldOps<field>::DestroyN(memory.GetAllocator(), memory.GetAddress(), size_);
+            } else {
+                FieldOps<field>::TransferN(memory.GetAllocator(), memory.GetAddress(), size_,
+                                           Memory<field>(new_data).GetAddress());
+            }
+        });
+    }
+
+    void Replace(Storage& new_data, size_t new_capacity) noexcept {
+        ForEachField([&](auto field) {
+            Memory<field>(data_).Swap(Memory<field>(new_data));
+        });
+        capacity_ = new_capacity;
+    }
+};
@@ -0,0 +1,121 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace detail {
+
+// Указатель на элементы непрерывного контейнера: Data(), если он есть, иначе begin().
+// Итераторы Vector с проверками (VECTOR_HARDENING_ITERATORS) не являются указателями, а Data() — всегда
+template <typename Container>
+auto ContiguousData(Container& container, int) noexcept -> decltype(container.Data()) {
+    return container.Data();
+}
+
+template <typename Container>
+auto ContiguousData(Container& container, long) noexcept -> decltype(container.begin()) {
+    return container.begin();
+}
+
+template <typename Container>
+using ContiguousPointer = decltype(ContiguousData(std::declval<Container&>(), 0));
+
+}  // namespace detail
+
+// Невладеющее представление непрерывной последовательности элементов, аналог std::span из C++20.
+// Строится из указателя и длины либо из контейнера, Data() или begin() которого возвращает указатель,
+// например, из Vector, SmallVector или MappedVector
+template <typename T>
+class Span {
+    template <typename Container>
+    using RequireContiguous
+        = std::enable_if_t<std::is_pointer_v<detail::ContiguousPointer<Container>>
+                           && std::is_convertible_v<detail::ContiguousPointer<Container>, T*>
+                           && std::is_convertible_v<decltype(std::declval<Container&>().Size()), size_t>>;
+
+public:
+    using value_type = std::remove_cv_t<T>;
+    using iterator = T*;
+
+    Span() noexcept = default;
+
+    Span(T* data, size_t size) noexcept
+        : data_(data)
+        , size_(size) {
+    }
+
+    template <typename Container, typename = RequireContiguous<Container>>
+    Span(Container& container) noexcept
+        : data_(detail::ContiguousData(container, 0))
+        , size_(container.Size()) {
+    }
+
+    // Span<T> приводится к Span<const T>
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U (*)[], T (*)[]>>>
+    Span(const Span<U>& other) noexcept
+        : data_(other.Data())
+        , size_(other.Size()) {
+    }
+
+    T* Data() const noexcept {
+        return data_;
+    }
+
+    size_t Size() const noexcept {
+        return size_;
+    }
+
+    size_t SizeBytes() const noexcept {
+        return size_ * sizeof(T);
+    }
+
+    bool Empty() const noexcept {
+        return size_ == 0;
+    }
+
+    T& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    Span First(size_t count) const noexcept {
+        assert(count <= size_);
+        return {data_, count};
+    }
+
+    Span Last(size_t count) const noexcept {
+        assert(count <= size_);
+        return {data_ + (size_ - count), count};
+    }
+
+    Span Subspan(size_t offset, size_t count) const noexcept {
+        assert(offset <= size_ && count <= size_ - offset);
+        return {data_ + offset, count};
+    }
+
+    iterator begin() const noexcept {
+        return data_;
+    }
+
+    iterator end() const noexcept {
+        return data_ + size_;
+    }
+
+private:
+    T* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+template <typename Container>
+Span(Container&) -> Span<std::remove_pointer_t<detail::ContiguousPointer<Container>>>;
+
+template <typename T>
+Span<const std::byte> AsBytes(Span<T> span) noexcept {
+    return {reinterpret_cast<const std::byte*>(span.Data()), span.SizeBytes()};
+}
+
+template <typename T, typename = std::enable_if_t<!std::is_const_v<T>>>
+Span<std::byte> AsWritableBytes(Span<T> span) noexcept {
+    return {reinterpret_cast<std::byte*>(span.Data()), span.SizeBytes()};
+}
@@ -0,0 +1,211 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "vector_config.h"
+
+// Пул потоков для параллельных операций над большими векторами. Вызывающий поток
+// участвует в выполнении задания наравне с потоками пула. Индексы задания делятся между потоками
+// на непрерывные диапазоны; поток, обработавший свой диапазон, забирает половину оставшейся части
+// диапазона другого потока (work stealing), поэтому неравномерная нагрузка выравнивается
+class ThreadPool {
+public:
+    // Пул из num_threads потоков, включая вызывающий. При num_threads <= 1 задания выполняются последовательно
+    explicit ThreadPool(size_t num_threads = std::thread::hardware_concurrency()) {
+        const size_t num_workers = num_threads > 1 ? num_threads - 1 : 0;
+        workers_.reserve(num_workers);
+        for (size_t i = 0; i < num_workers; ++i) {
+            // Диапазон с номером 0 обрабатывает вызывающий поток
+            workers_.emplace_back([this, slot = i + 1] {
+                WorkerLoop(slot);
+            });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        job_ready_.notify_all();
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    // Число потоков, выполняющих задания, включая вызывающий
+    size_t Concurrency() const noexcept {
+        return workers_.size() + 1;
+    }
+
+    // Вызывает task(i) для каждого i из [0, count), распределяя индексы между потоками.
+    // Возвращает управление, когда все вызовы завершены. Если task выбросил исключение,
+    // оставшиеся индексы не обрабатываются, а первое исключение выбрасывается повторно.
+    // Вложенные вызовы из task выполняются последовательно в том же потоке
+    template <typename Task>
+    void ParallelFor(size_t count, Task&& task) {
+        if (count == 0) {
+            return;
+        }
+        if (workers_.empty() || count == 1 || inside_task_) {
+            for (size_t i = 0; i < count; ++i) {
+                task(i);
+            }
+            return;
+        }
+
+        Job job(count, Concurrency());
+        job.task = [&task](size_t i) {
+            task(i);
+        };
+
+        // Задания разных вызывающих потоков выполняются по очереди
+        std::lock_guard submit_lock(submit_mutex_);
+        {
+            std::lock_guard lock(mutex_);
+            job_ = &job;
+            ++generation_;
+        }
+        job_ready_.notify_all();
+
+        Run(job, 0);
+
+        std::unique_lock lock(mutex_);
+        job_done_.wait(lock, [&job] {
+            return job.active_workers == 0;
+        });
+        job_ = nullptr;
+        lock.unlock();
+
+        if (job.error) {
+            std::rethrow_exception(job.error);
+        }
+    }
+
+private:
+    // Необработанные индексы [begin, end) одного потока. Диапазоны выровнены по кэш-линии,
+    // чтобы потоки, обращающиеся к своим диапазонам, не мешали друг другу
+    struct alignas(64) Range {
+        std::mutex mutex;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    struct Job {
+        Job(size_t count, size_t num_slots)
+            : ranges(new Range[num_slots])
+            , num_slots(num_slots) {
+            for (size_t slot = 0; slot < num_slots; ++slot) {
+                ranges[slot].begin = count * slot / num_slots;
+                ranges[slot].end = count * (slot + 1) / num_slots;
+            }
+        }
+
+        std::function<void(size_t)> task;
+        std::unique_ptr<Range[]> ranges;
+        size_t num_slots;
+        std::atomic<bool> failed{false};
+        std::exception_ptr error;
+        std::mutex error_mutex;
+        // Число потоков пула, выполняющих задание; защищено mutex_ пула
+        size_t active_workers = 0;
+    };
+
+    std::vector<std::thread> workers_;
+    std::mutex submit_mutex_;
+    std::mutex mutex_;
+    std::condition_variable job_ready_;
+    std::condition_variable job_done_;
+    Job* job_ = nullptr;
+    size_t generation_ = 0;
+    bool stopping_ = false;
+
+    inline static thread_local bool inside_task_ = false;
+
+    // Выдаёт следующий индекс из диапазона slot, при его исчерпании забирая работу у других потоков
+    static bool NextIndex(Job& job, size_t slot, size_t& index) {
+        Range& own = job.ranges[slot];
+        {
+            std::lock_guard lock(own.mutex);
+            if (own.begin != own.end) {
+                index = own.begin++;
+                return true;
+            }
+        }
+
+        for (size_t shift = 1; shift < job.num_slots; ++shift) {
+            Range& victim = job.ranges[(slot + shift) % job.num_slots];
+            size_t begin = 0;
+            size_t end = 0;
+            {
+                std::lock_guard lock(victim.mutex);
+                const size_t stolen = (victim.end - victim.begin + 1) / 2;
+                if (stolen == 0) {
+                    continue;
+                }
+                end = victim.end;
+                begin = victim.end -= stolen;
+            }
+
+            index = begin;
+            std::lock_guard lock(own.mutex);
+            own.begin = begin + 1;
+            own.end = end;
+            return true;
+        }
+        return false;
+    }
+
+    static void Run(Job& job, size_t slot) noexcept {
+        inside_task_ = true;
+        size_t i = 0;
+        while (!job.failed.load(std::memory_order_relaxed) && NextIndex(job, slot, i)) {
+            VECTOR_TRY {
+                job.task(i);
+            } VECTOR_CATCH_ALL {
+                std::lock_guard lock(job.error_mutex);
+                if (!job.error) {
+                    job.error = std::current_exception();
+                }
+                job.failed.store(true, std::memory_order_relaxed);
+            }
+        }
+        inside_task_ = false;
+    }
+
+    void WorkerLoop(size_t slot) {
+        size_t seen_generation = 0;
+        std::unique_lock lock(mutex_);
+        while (true) {
+            job_ready_.wait(lock, [this, &seen_generation] {
+                return stopping_ || (job_ != nullptr && generation_ != seen_generation);
+            });
+            if (stopping_) {
+                return;
+            }
+            seen_generation = generation_;
+            Job& job = *job_;
+            ++job.active_workers;
+            lock.unlock();
+
+            Run(job, slot);
+
+            lock.lock();
+            --job.active_workers;
+            if (job.active_workers == 0) {
+                job_done_.notify_all();
+            }
+        }
+    }
+};
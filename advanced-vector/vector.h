@@ -1,336 +1,2139 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
 #include <new>
+#include <stdexcept>
+#include <tuple>
 #include <utility>
 #include <memory>
+#include <memory_resource>
+#include <type_traits>
 
+#include "vector_config.h"
+
+// Пул потоков для параллельных конструкторов, Assign и Clear вектора. Распределение работы
+// между потоками определено в parallel_algorithms.h, поэтому vector.h не требует <thread>
+// и сборки с -pthread
+class ThreadPool;
+
+// Тип тривиально перемещаем (trivially relocatable), если перенос объекта в другую память
+// побайтовым копированием без вызова деструктора исходного объекта эквивалентен
+// перемещению и последующему разрушению. Шаблон можно специализировать для своих типов.
+// std::string в libstdc++ хранит указатель на собственный буфер и потому таковым не является
 template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {
+};
+
+template <typename T>
+struct IsTriviallyRelocatable<std::unique_ptr<T>> : std::true_type {
+};
+
+template <typename T>
+struct IsTriviallyRelocatable<std::shared_ptr<T>> : std::true_type {
+};
+
+namespace detail {
+
+template <typename It>
+using IteratorCategory = typename std::iterator_traits<It>::iterator_category;
+
+// Отсекает перегрузки с парой итераторов, например, от Vector(size_t, ...)
+template <typename It>
+using RequireInputIterator = std::enable_if_t<std::is_convertible_v<IteratorCategory<It>, std::input_iterator_tag>>;
+
+template <typename It>
+inline constexpr bool IS_FORWARD_ITERATOR = std::is_convertible_v<IteratorCategory<It>, std::forward_iterator_tag>;
+
+// Отсекает параллельные перегрузки, например, Vector(const Vector&, Pool&) от Vector(const Vector&, const Allocator&)
+template <typename Pool>
+using RequireThreadPool = std::enable_if_t<std::is_same_v<Pool, ThreadPool>>;
+
+// Параллельное конструирование и разрушение элементов для перегрузок Vector, принимающих пул.
+// Специализация для ThreadPool определена в parallel_algorithms.h; без этого заголовка такие
+// перегрузки не компилируются, а не оставляют неразрешённые символы компоновщику
+template <typename Pool>
+struct ParallelElementOps;
+
+template <typename Allocator, typename T, typename = void>
+struct HasConstruct : std::false_type {
+};
+
+template <typename Allocator, typename T>
+struct HasConstruct<Allocator, T,
+                    std::void_t<decltype(std::declval<Allocator&>().construct(std::declval<T*>(), std::declval<T&&>()))>>
+    : std::true_type {
+};
+
+template <typename Allocator, typename T, typename = void>
+struct HasDestroy : std::false_type {
+};
+
+template <typename Allocator, typename T>
+struct HasDestroy<Allocator, T, std::void_t<decltype(std::declval<Allocator&>().destroy(std::declval<T*>()))>>
+    : std::true_type {
+};
+
+// Аллокатор может расширить блок, не перемещая его:
+// bool try_expand(T* p, size_t old_n, size_t new_n)
+template <typename Allocator, typename T, typename = void>
+struct HasTryExpand : std::false_type {
+};
+
+template <typename Allocator, typename T>
+struct HasTryExpand<Allocator, T,
+                    std::void_t<decltype(std::declval<Allocator&>().try_expand(
+                        std::declval<T*>(), std::declval<size_t>(), std::declval<size_t>()))>> : std::true_type {
+};
+
+// Аллокатор может изменить размер блока, перенеся его содержимое побайтово, как realloc:
+// T* reallocate(T* p, size_t old_n, size_t new_n)
+template <typename Allocator, typename T, typename = void>
+struct HasReallocate : std::false_type {
+};
+
+template <typename Allocator, typename T>
+struct HasReallocate<Allocator, T,
+                     std::void_t<decltype(std::declval<Allocator&>().reallocate(
+                         std::declval<T*>(), std::declval<size_t>(), std::declval<size_t>()))>> : std::true_type {
+};
+
+// Аллокатор возвращает блок вместе с реальным числом элементов, которые в нём помещаются:
+// AllocationResult<T> allocate_at_least(size_t n)
+template <typename Allocator, typename = void>
+struct HasAllocateAtLeast : std::false_type {
+};
+
+template <typename Allocator>
+struct HasAllocateAtLeast<Allocator,
+                          std::void_t<decltype(std::declval<Allocator&>().allocate_at_least(std::declval<size_t>()))>>
+    : std::true_type {
+};
+
+// Аллокатор сообщает о нехватке памяти нулевым указателем, а не исключением:
+// T* try_allocate(size_t n) noexcept
+template <typename Allocator, typename = void>
+struct HasTryAllocate : std::false_type {
+};
+
+template <typename Allocator>
+struct HasTryAllocate<Allocator, std::void_t<decltype(std::declval<Allocator&>().try_allocate(std::declval<size_t>()))>>
+    : std::true_type {
+};
+
+// Стратегия роста уменьшает ёмкость вектора после удаления элементов:
+// static size_t ShrinkCapacity(size_t capacity, size_t size, size_t element_size)
+template <typename GrowthPolicy, typename = void>
+struct HasShrinkCapacity : std::false_type {
+};
+
+template <typename GrowthPolicy>
+struct HasShrinkCapacity<GrowthPolicy, std::void_t<decltype(GrowthPolicy::ShrinkCapacity(
+                                           std::declval<size_t>(), std::declval<size_t>(), std::declval<size_t>()))>>
+    : std::true_type {
+};
+
+// Истинно, если construct/destroy аллокатора сводятся к placement new и вызову деструктора,
+// то есть их можно обойти при побайтовом переносе элементов
+template <typename T, typename Allocator>
+struct UsesDefaultConstruct
+    : std::negation<std::disjunction<HasConstruct<Allocator, T>, HasDestroy<Allocator, T>>> {
+};
+
+template <typename T>
+struct UsesDefaultConstruct<T, std::allocator<T>> : std::true_type {
+};
+
+template <typename T>
+struct UsesDefaultConstruct<T, std::pmr::polymorphic_allocator<T>>
+    : std::negation<std::uses_allocator<T, std::pmr::polymorphic_allocator<T>>> {
+};
+
+}  // namespace detail
+
+// Результат allocate_at_least: указатель на блок и число элементов, которые в нём помещаются
+template <typename T>
+struct AllocationResult {
+    T* ptr;
+    size_t count;
+};
+
+// Тег конструктора и Resize, которые инициализируют новые элементы по умолчанию (default-init),
+// то есть оставляют память под элементы тривиальных типов неинициализированной
+struct DefaultInitT {
+    explicit DefaultInitT() = default;
+};
+
+inline constexpr DefaultInitT default_init{};
+
+// Тег конструкторов, принимающих во владение буфер, выделенный аллокатором контейнера
+struct AdoptT {
+    explicit AdoptT() = default;
+};
+
+inline constexpr AdoptT adopt{};
+
+// Буфер, отданный вектором методом Release: size сконструированных элементов в памяти,
+// выделенной под capacity элементов
+template <typename T>
+struct ReleasedBuffer {
+    T* ptr = nullptr;
+    size_t size = 0;
+    size_t capacity = 0;
+};
+
+// Стратегия роста по умолчанию: ёмкость удваивается, начиная с одного элемента
+struct DoublingGrowth {
+    // Возвращает ёмкость нового буфера, когда в текущем (capacity) не помещается required элементов
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t /*element_size*/) noexcept {
+        const size_t grown = capacity == 0 ? 1 : capacity > SIZE_MAX / 2 ? SIZE_MAX : capacity * 2;
+        return std::max(grown, required);
+    }
+};
+
+// Геометрический рост с коэффициентом Numerator / Denominator (по умолчанию 1.5).
+// Первый буфер занимает не меньше MinBytes (например, кэш-линию или страницу),
+// а при ненулевом MaxStepBytes прирост ёмкости за одну реаллокацию не превышает MaxStepBytes
+template <size_t Numerator = 3, size_t Denominator = 2, size_t MinBytes = 64, size_t MaxStepBytes = 0>
+struct GeometricGrowth {
+    static_assert(Numerator > Denominator && Denominator != 0, "Growth factor must be greater than 1");
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        size_t grown = std::max<size_t>(MinBytes / element_size, 1);
+        if (capacity != 0) {
+            const size_t step = std::max<size_t>(capacity / Denominator * (Numerator - Denominator), 1);
+            grown = capacity + std::min(step, SIZE_MAX - capacity);
+            if constexpr (MaxStepBytes != 0) {
+                grown = std::min(grown, capacity + std::max<size_t>(MaxStepBytes / element_size, 1));
+            }
+        }
+        return std::max(grown, required);
+    }
+};
+
+// Адаптер стратегии роста, возвращающий память после удаления элементов: когда размер опускается
+// ниже 1/Divisor ёмкости, буфер заменяется вдвое большим размера. Между уменьшением и следующим
+// ростом размер должен измениться как минимум вдвое, поэтому чередование вставок и удалений
+// на границе не приводит к реаллокации на каждой операции
+template <typename Growth = DoublingGrowth, size_t Divisor = 4>
+struct ShrinkingGrowth {
+    static_assert(Divisor > 2, "Shrinking to twice the size must leave room for growth");
+
+    static constexpr size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        return Growth::NextCapacity(capacity, required, element_size);
+    }
+
+    // Возвращает новую ёмкость буфера, на котором осталось size элементов, либо capacity,
+    // если уменьшать буфер не нужно
+    static constexpr size_t ShrinkCapacity(size_t capacity, size_t size, size_t /*element_size*/) noexcept {
+        return size < capacity / Divisor ? size * 2 : capacity;
+    }
+};
+
+// Политика инструментирования по умолчанию: события не учитываются, вызовы удаляются компилятором.
+// Счётчики событий реализует CountingInstrumentation (instrumentation.h)
+struct NoInstrumentation {
+    // Выделен буфер размером bytes
+    static constexpr void OnAllocate(size_t /*bytes*/) noexcept {
+    }
+
+    // Буфер вектора заменён новым либо расширен на месте
+    static constexpr void OnReallocate() noexcept {
+    }
+
+    // При замене буфера moved элементов перемещено и copied скопировано
+    static constexpr void OnTransfer(size_t /*moved*/, size_t /*copied*/) noexcept {
+    }
+
+    // Ёмкость вектора стала равна capacity элементам
+    static constexpr void OnCapacity(size_t /*capacity*/) noexcept {
+    }
+};
+
+template <typename T, typename Allocator = std::allocator<T>>
 class RawMemory {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    static_assert(std::is_same_v<typename AllocTraits::value_type, T>,
+                  "Allocator::value_type must be the same as T");
+    static_assert(std::is_same_v<typename AllocTraits::pointer, T*>,
+                  "Fancy pointers are not supported");
+
 public:
+    using allocator_type = Allocator;
+
+    static constexpr bool CAN_REALLOCATE = detail::HasReallocate<Allocator, T>::value;
+
     RawMemory() = default;
 
-    explicit RawMemory(size_t capacity)
-        : buffer_(Allocate(capacity))
-        , capacity_(capacity) {
+    VECTOR_CONSTEXPR explicit RawMemory(const Allocator& alloc) noexcept
+        : alloc_(alloc) {
+    }
+
+    // Allocate может увеличить capacity, поэтому buffer_ инициализируется раньше capacity_
+    VECTOR_CONSTEXPR explicit RawMemory(size_t capacity, const Allocator& alloc = Allocator())
+        : alloc_(alloc)
+        , buffer_(Allocate(capacity))
+        , capacity_(capacity) {
+    }
+
+    // Принимает во владение buffer, выделенный alloc (или равным ему аллокатором) под capacity элементов
+    VECTOR_CONSTEXPR RawMemory(AdoptT, T* buffer, size_t capacity, const Allocator& alloc = Allocator()) noexcept
+        : alloc_(alloc)
+        , buffer_(buffer)
+        , capacity_(capacity) {
+    }
+
+    RawMemory(const RawMemory&) = delete;
+    RawMemory& operator=(const RawMemory& rhs) = delete;
+
+    VECTOR_CONSTEXPR RawMemory(RawMemory&& other) noexcept
+        : alloc_(std::move(other.alloc_)) {
+        capacity_ = std::exchange(other.capacity_, 0);
+        buffer_ = std::exchange(other.buffer_, nullptr);
+    }
+
+    // Если аллокатор не распространяется при перемещении, вызывающий код
+    // обязан гарантировать, что аллокаторы *this и rhs равны
+    VECTOR_CONSTEXPR RawMemory& operator=(RawMemory&& rhs) noexcept {
+        if (this != &rhs) {
+            Deallocate(buffer_, capacity_);
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                alloc_ = std::move(rhs.alloc_);
+            }
+            capacity_ = std::exchange(rhs.capacity_, 0);
+            buffer_ = std::exchange(rhs.buffer_, nullptr);
+        }
+        return *this;
+    }
+
+    VECTOR_CONSTEXPR ~RawMemory() {
+        Deallocate(buffer_, capacity_);
+    }
+    VECTOR_CONSTEXPR T* operator+(size_t offset) noexcept {
+        assert(offset <= capacity_);
+        return buffer_ + offset;
+    }
+
+    VECTOR_CONSTEXPR const T* operator+(size_t offset) const noexcept {
+        return const_cast<RawMemory&>(*this) + offset;
+    }
+
+    VECTOR_CONSTEXPR const T& operator[](size_t index) const noexcept {
+        return const_cast<RawMemory&>(*this)[index];
+    }
+
+    VECTOR_CONSTEXPR T& operator[](size_t index) noexcept {
+        assert(index < capacity_);
+        return buffer_[index];
+    }
+
+    // Аллокаторы обмениваются, только если этого требует propagate_on_container_swap
+    VECTOR_CONSTEXPR void Swap(RawMemory& other) noexcept {
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        }
+        std::swap(buffer_, other.buffer_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    // Освобождает буфер, если он не может быть освобождён аллокатором alloc,
+    // и заменяет текущий аллокатор на alloc
+    VECTOR_CONSTEXPR void AssignAllocator(const Allocator& alloc) {
+        if (alloc_ != alloc) {
+            Deallocate(buffer_, capacity_);
+            buffer_ = nullptr;
+            capacity_ = 0;
+        }
+        alloc_ = alloc;
+    }
+
+    // Пытается увеличить ёмкость до new_capacity, не перемещая буфер.
+    // Возможно, только если аллокатор предоставляет try_expand
+    VECTOR_CONSTEXPR bool TryExpand(size_t new_capacity) noexcept {
+        if constexpr (detail::HasTryExpand<Allocator, T>::value) {
+            if (buffer_ != nullptr && alloc_.try_expand(buffer_, capacity_, new_capacity)) {
+                capacity_ = new_capacity;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Изменяет ёмкость при помощи reallocate аллокатора. Содержимое буфера переносится побайтово,
+    // поэтому вызывающий код обязан использовать этот метод только для тривиально перемещаемых типов
+    VECTOR_CONSTEXPR void Reallocate(size_t new_capacity) {
+        static_assert(CAN_REALLOCATE, "Allocator does not provide reallocate");
+        if (buffer_ == nullptr) {
+            buffer_ = Allocate(new_capacity);
+        } else {
+            buffer_ = alloc_.reallocate(buffer_, capacity_, new_capacity);
+        }
+        capacity_ = new_capacity;
+    }
+
+    // Выделяет буфер под capacity элементов в пустом RawMemory, не выбрасывая исключений.
+    // Возвращает false, если памяти не хватило
+    [[nodiscard]] VECTOR_CONSTEXPR bool TryAllocate(size_t capacity) noexcept {
+        assert(buffer_ == nullptr);
+        buffer_ = TryAllocateBuffer(capacity);
+        if (buffer_ == nullptr && capacity != 0) {
+            return false;
+        }
+        capacity_ = capacity;
+        return true;
+    }
+
+    // Отказывается от владения буфером. Освободить его должен вызывающий код тем же аллокатором
+    [[nodiscard]] VECTOR_CONSTEXPR AllocationResult<T> Release() noexcept {
+        return {std::exchange(buffer_, nullptr), std::exchange(capacity_, 0)};
+    }
+
+    VECTOR_CONSTEXPR const Allocator& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    VECTOR_CONSTEXPR Allocator& GetAllocator() noexcept {
+        return alloc_;
+    }
+
+    VECTOR_CONSTEXPR const T* GetAddress() const noexcept {
+        return buffer_;
+    }
+
+    VECTOR_CONSTEXPR T* GetAddress() noexcept {
+        return buffer_;
+    }
+
+    VECTOR_CONSTEXPR size_t Capacity() const {
+        return capacity_;
+    }
+
+private:
+    // Выделяет сырую память не менее чем под n элементов и возвращает указатель на неё.
+    // Если аллокатор сообщает реальный размер блока (allocate_at_least), n увеличивается до него
+    VECTOR_CONSTEXPR T* Allocate(size_t& n) {
+        if (n == 0) {
+            return nullptr;
+        }
+        if constexpr (detail::HasAllocateAtLeast<Allocator>::value) {
+            auto [ptr, count] = alloc_.allocate_at_least(n);
+            n = count;
+            return ptr;
+        } else {
+            return AllocTraits::allocate(alloc_, n);
+        }
+    }
+
+    // Как Allocate, но при нехватке памяти возвращает nullptr. Без хука try_allocate память для
+    // std::allocator выделяется nothrow-версией operator new, совместимой с его deallocate; для других
+    // аллокаторов перехватывается исключение, а в сборке без исключений ошибка завершает программу
+    VECTOR_CONSTEXPR T* TryAllocateBuffer(size_t n) noexcept {
+        if (n == 0) {
+            return nullptr;
+        }
+        if constexpr (detail::HasTryAllocate<Allocator>::value) {
+            return alloc_.try_allocate(n);
+        } else if constexpr (std::is_same_v<Allocator, std::allocator<T>>) {
+            if (VECTOR_IS_CONSTANT_EVALUATED()) {
+                return AllocTraits::allocate(alloc_, n);
+            }
+            if (n > AllocTraits::max_size(alloc_)) {
+                return nullptr;
+            }
+            if constexpr (alignof(T) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+                return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{alignof(T)}, std::nothrow));
+            } else {
+                return static_cast<T*>(::operator new(n * sizeof(T), std::nothrow));
+            }
+        } else {
+            VECTOR_TRY {
+                return Allocate(n);
+            } VECTOR_CATCH_ALL {
+                return nullptr;
+            }
+        }
+    }
+
+    // Освобождает сырую память под n элементов, выделенную ранее по адресу buf при помощи Allocate
+    VECTOR_CONSTEXPR void Deallocate(T* buf, size_t n) noexcept {
+        if (buf != nullptr) {
+            AllocTraits::deallocate(alloc_, buf, n);
+        }
+    }
+
+    Allocator alloc_;
+    T* buffer_ = nullptr;
+    size_t capacity_ = 0;
+};
+
+namespace detail {
+
+inline constexpr size_t CACHE_LINE_SIZE = 64;
+
+// Неинициализированная память под один временный элемент на стеке. При вычислении на этапе
+// компиляции reinterpret_cast недоступен, и память выделяется std::allocator
+template <typename T>
+class TemporarySlot {
+public:
+    VECTOR_CONSTEXPR TemporarySlot() {
+        if (VECTOR_IS_CONSTANT_EVALUATED()) {
+            ptr_ = std::allocator<T>().allocate(1);
+        } else {
+            ptr_ = reinterpret_cast<T*>(storage_);
+        }
+    }
+
+    TemporarySlot(const TemporarySlot&) = delete;
+    TemporarySlot& operator=(const TemporarySlot&) = delete;
+
+    VECTOR_CONSTEXPR ~TemporarySlot() {
+        if (VECTOR_IS_CONSTANT_EVALUATED()) {
+            std::allocator<T>().deallocate(ptr_, 1);
+        }
+    }
+
+    VECTOR_CONSTEXPR T* Get() const noexcept {
+        return ptr_;
+    }
+
+private:
+    alignas(T) unsigned char storage_[sizeof(T)];
+    T* ptr_;
+};
+
+// Операции над элементами в сырой памяти, общие для Vector и SmallVector:
+// конструирование через аллокатор, перенос в новый буфер, вставка и удаление со сдвигом
+template <typename T, typename Allocator>
+struct ElementOps {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+    // Элементы можно переносить в новую память побайтово, без конструкторов и деструкторов
+    static constexpr bool CAN_RELOCATE = IsTriviallyRelocatable<T>::value && UsesDefaultConstruct<T, Allocator>::value;
+
+    // Буфер можно наращивать через reallocate аллокатора (например, realloc)
+    static constexpr bool CAN_REALLOCATE = CAN_RELOCATE && RawMemory<T, Allocator>::CAN_REALLOCATE;
+
+    // Элементы можно сдвигать внутри буфера с возможностью отката при исключении
+    static constexpr bool CAN_SHIFT = CAN_RELOCATE || std::is_nothrow_move_constructible_v<T>;
+
+    // Удаление со сдвигом следующих элементов не выбрасывает исключений
+    static constexpr bool NOTHROW_ERASE = CAN_RELOCATE || std::is_nothrow_move_assignable_v<T>;
+
+    // Копирование из непрерывного диапазона [first, first + n) сводится к memcpy
+    template <typename InputIt>
+    static constexpr bool CAN_MEMCPY_FROM = std::is_trivially_copyable_v<T> && UsesDefaultConstruct<T, Allocator>::value
+                                            && std::is_pointer_v<InputIt>
+                                            && std::is_same_v<std::remove_cv_t<std::remove_pointer_t<InputIt>>, T>;
+
+    // Элементы конструируются и разрушаются только через аллокатор,
+    // чтобы поддержать аллокаторы с собственными construct/destroy (например, pmr)
+    template <typename... Args>
+    static VECTOR_CONSTEXPR void Construct(Allocator& alloc, T* p, Args&&... args) {
+        AllocTraits::construct(alloc, p, std::forward<Args>(args)...);
+    }
+
+    static VECTOR_CONSTEXPR void Destroy(Allocator& alloc, T* p) noexcept {
+        AllocTraits::destroy(alloc, p);
+    }
+
+    static VECTOR_CONSTEXPR void DestroyN(Allocator& alloc, T* first, size_t number_elements) noexcept {
+        for (size_t i = 0; i < number_elements; ++i) {
+            Destroy(alloc, first + i);
+        }
+    }
+
+    // При исключении уже сконструированные элементы разрушаются
+    static VECTOR_CONSTEXPR void UninitializedValueConstructN(Allocator& alloc, T* first, size_t number_elements) {
+        size_t i = 0;
+        VECTOR_TRY {
+            for (; i < number_elements; ++i) {
+                Construct(alloc, first + i);
+            }
+        } VECTOR_CATCH_ALL {
+            DestroyN(alloc, first, i);
+            VECTOR_RETHROW();
+        }
+    }
+
+    template <typename InputIt>
+    static VECTOR_CONSTEXPR void UninitializedCopyN(Allocator& alloc, InputIt first, size_t number_elements,
+                                                    T* d_first) {
+        if constexpr (CAN_MEMCPY_FROM<InputIt>) {
+            if (!VECTOR_IS_CONSTANT_EVALUATED()) {
+                if (number_elements != 0) {
+                    std::memcpy(static_cast<void*>(d_first), static_cast<const void*>(first),
+                                number_elements * sizeof(T));
+                }
+                return;
+            }
+        }
+        size_t i = 0;
+        VECTOR_TRY {
+            for (; i < number_elements; ++i, ++first) {
+                Construct(alloc, d_first + i, *first);
+            }
+        } VECTOR_CATCH_ALL {
+            DestroyN(alloc, d_first, i);
+            VECTOR_RETHROW();
+        }
+    }
+
+    template <typename InputIt>
+    static VECTOR_CONSTEXPR void UninitializedMoveN(Allocator& alloc, InputIt first, size_t number_elements,
+                                                    T* d_first) {
+        if constexpr (CAN_MEMCPY_FROM<InputIt>) {
+            UninitializedCopyN(alloc, first, number_elements, d_first);
+        } else {
+            UninitializedCopyN(alloc, std::make_move_iterator(first), number_elements, d_first);
+        }
+    }
+
+    static VECTOR_CONSTEXPR void UninitializedFillN(Allocator& alloc, T* first, size_t number_elements,
+                                                    const T& value) {
+        size_t i = 0;
+        VECTOR_TRY {
+            for (; i < number_elements; ++i) {
+                Construct(alloc, first + i, value);
+            }
+        } VECTOR_CATCH_ALL {
+            DestroyN(alloc, first, i);
+            VECTOR_RETHROW();
+        }
+    }
+
+    // Присваивает d_size элементам d_first значения count элементов из first, конструируя
+    // недостающие и разрушая лишние. Для тривиально копируемых типов сводится к одному memmove
+    template <typename InputIt>
+    static VECTOR_CONSTEXPR void AssignN(Allocator& alloc, InputIt first, size_t count, T* d_first, size_t d_size) {
+        if constexpr (CAN_MEMCPY_FROM<InputIt>) {
+            if (!VECTOR_IS_CONSTANT_EVALUATED()) {
+                if (count != 0) {
+                    std::memmove(static_cast<void*>(d_first), static_cast<const void*>(first), count * sizeof(T));
+                }
+                return;
+            }
+        }
+        const size_t common_size = std::min(d_size, count);
+        InputIt mid = std::next(first, common_size);
+        std::copy(first, mid, d_first);
+        if (d_size > count) {
+            DestroyN(alloc, d_first + count, d_size - count);
+        } else {
+            UninitializedCopyN(alloc, mid, count - common_size, d_first + common_size);
+        }
+    }
+
+    // Перемещение может выбросить исключение, поэтому UninitializedCopyOrMove копирует элементы
+    static constexpr bool COPY_OR_MOVE_COPIES
+        = !std::is_nothrow_move_constructible_v<T> && std::is_copy_constructible_v<T>;
+
+    // TransferN копирует элементы вместо перемещения
+    static constexpr bool TRANSFER_COPIES = !CAN_RELOCATE && COPY_OR_MOVE_COPIES;
+
+    // TransferN не выбрасывает исключений: элементы переносятся побайтно или перемещаются без исключений
+    static constexpr bool NOTHROW_TRANSFER = CAN_RELOCATE || std::is_nothrow_move_constructible_v<T>;
+
+    template <typename InputIt>
+    static VECTOR_CONSTEXPR void UninitializedCopyOrMove(Allocator& alloc, InputIt first, size_t number_elements,
+                                                         T* d_first) {
+        if constexpr (COPY_OR_MOVE_COPIES) {
+            UninitializedCopyN(alloc, first, number_elements, d_first);
+        } else {
+            UninitializedMoveN(alloc, first, number_elements, d_first);
+        }
+    }
+
+    // Переносит элементы в неинициализированную память; исходные элементы
+    // после этого считаются разрушенными. Диапазоны могут перекрываться
+    static VECTOR_CONSTEXPR void RelocateN(T* first, size_t number_elements, T* d_first) noexcept {
+        static_assert(CAN_RELOCATE);
+        if (VECTOR_IS_CONSTANT_EVALUATED()) {
+            RelocateElementwise(first, number_elements, d_first);
+        } else if (number_elements != 0) {
+            std::memmove(static_cast<void*>(d_first), static_cast<const void*>(first), number_elements * sizeof(T));
+        }
+    }
+
+    // RelocateN при вычислении на этапе компиляции, где memmove недоступен. Направление переноса
+    // перекрывающихся диапазонов определить нельзя: указатели на разные буферы там не сравниваются,
+    // поэтому элементы переносятся через промежуточный буфер
+    static VECTOR_CONSTEXPR void RelocateElementwise(T* first, size_t number_elements, T* d_first) {
+        if (number_elements == 0) {
+            return;
+        }
+        std::allocator<T> alloc;
+        T* buffer = alloc.allocate(number_elements);
+        for (size_t i = 0; i < number_elements; ++i) {
+            std::allocator_traits<std::allocator<T>>::construct(alloc, buffer + i, std::move(first[i]));
+            std::allocator_traits<std::allocator<T>>::destroy(alloc, first + i);
+        }
+        for (size_t i = 0; i < number_elements; ++i) {
+            std::allocator_traits<std::allocator<T>>::construct(alloc, d_first + i, std::move(buffer[i]));
+            std::allocator_traits<std::allocator<T>>::destroy(alloc, buffer + i);
+        }
+        alloc.deallocate(buffer, number_elements);
+    }
+
+    // Переносит элементы в новый буфер. Если элементы приходится копировать и копирование
+    // выбрасывает исключение, исходные элементы остаются нетронутыми
+    static VECTOR_CONSTEXPR void TransferN(Allocator& alloc, T* first, size_t number_elements, T* d_first) {
+        if constexpr (CAN_RELOCATE) {
+            RelocateN(first, number_elements, d_first);
+        } else {
+            UninitializedCopyOrMove(alloc, first, number_elements, d_first);
+            DestroyN(alloc, first, number_elements);
+        }
+    }
+
+    // Увеличивает ёмкость memory, сохраняя элементы на месте (try_expand) либо перенося весь буфер
+    // средствами аллокатора (reallocate). Возвращает false, если ни то, ни другое невозможно
+    static VECTOR_CONSTEXPR bool GrowInPlace(RawMemory<T, Allocator>& memory, size_t new_capacity) {
+        if (memory.TryExpand(new_capacity)) {
+            return true;
+        }
+        if constexpr (CAN_REALLOCATE) {
+            memory.Reallocate(new_capacity);
+            return true;
+        }
+        return false;
+    }
+
+    // Новый элемент можно сконструировать сразу на его месте после сдвига: числа и перечисления
+    // копируются до сдвига, поэтому не могут ссылаться на сдвигаемые элементы, а конструктор не бросает.
+    // Указатели исключены: конструктор прочитал бы элемент, на который указывает аргумент, уже после сдвига
+    template <typename... Args>
+    static constexpr bool CAN_CONSTRUCT_IN_PLACE
+        = ((std::is_arithmetic_v<std::decay_t<Args>> || std::is_enum_v<std::decay_t<Args>>) && ...)
+          && std::is_nothrow_constructible_v<T, std::decay_t<Args>&...>;
+
+    // Вставляет элемент в позицию offset буфера first, в котором есть место ещё хотя бы под один элемент.
+    // Динамическая память не выделяется: временный элемент, если он нужен, размещается на стеке
+    template <typename... Args>
+    static VECTOR_CONSTEXPR void EmplaceInPlace(Allocator& alloc, T* first, size_t size, size_t offset,
+                                                Args&&... args) {
+        T* last = first + size;
+        T* pos = first + offset;
+        if (offset == size) {
+            Construct(alloc, last, std::forward<Args>(args)...);
+
+        } else if constexpr (CAN_CONSTRUCT_IN_PLACE<Args...>) {
+            std::tuple<std::decay_t<Args>...> copies(args...);
+            ShiftRightByOne(alloc, pos, last);
+            if constexpr (!CAN_RELOCATE) {
+                Destroy(alloc, pos);
+            }
+            std::apply(
+                [&alloc, pos](auto&... values) {
+                    Construct(alloc, pos, values...);
+                },
+                copies);
+
+        } else {
+            // args могут ссылаться на сдвигаемые элементы, поэтому новый элемент
+            // конструируется до сдвига во временной памяти на стеке
+            TemporarySlot<T> slot;
+            T* tmp = slot.Get();
+            Construct(alloc, tmp, std::forward<Args>(args)...);
+
+            if constexpr (CAN_RELOCATE) {
+                RelocateN(pos, size - offset, pos + 1);
+                RelocateN(tmp, 1, pos);
+            } else {
+                VECTOR_TRY {
+                    ShiftRightByOne(alloc, pos, last);
+                    *pos = std::move(*tmp);
+                } VECTOR_CATCH_ALL {
+                    Destroy(alloc, tmp);
+                    VECTOR_RETHROW();
+                }
+                Destroy(alloc, tmp);
+            }
+        }
+    }
+
+    // Сдвигает элементы [pos, last) на одну позицию вправо. В позиции pos остаётся
+    // перемещённый элемент либо, для тривиально перемещаемых типов, неинициализированная память
+    static VECTOR_CONSTEXPR void ShiftRightByOne(Allocator& alloc, T* pos, T* last) {
+        if constexpr (CAN_RELOCATE) {
+            RelocateN(pos, last - pos, pos + 1);
+        } else {
+            Construct(alloc, last, std::forward<T>(*(last - 1)));
+            std::move_backward(pos, last - 1, last);
+        }
+    }
+
+    // Вставляет элемент в позицию offset, увеличивая буфер memory до new_capacity без выделения
+    // новой памяти средствами аллокатора. Возвращает false, если аллокатор этого не умеет
+    template <typename... Args>
+    static VECTOR_CONSTEXPR bool EmplaceGrowingInPlace(RawMemory<T, Allocator>& memory, size_t size, size_t offset,
+                                                       size_t new_capacity, Args&&... args) {
+        Allocator& alloc = memory.GetAllocator();
+        if (memory.TryExpand(new_capacity)) {
+            // Буфер остался на месте, поэтому ссылки в args по-прежнему действительны
+            EmplaceInPlace(alloc, memory.GetAddress(), size, offset, std::forward<Args>(args)...);
+            return true;
+        }
+
+        if constexpr (CAN_REALLOCATE) {
+            // reallocate может перенести буфер, а args — ссылаться на его элементы,
+            // поэтому новый элемент заранее конструируется во временной памяти на стеке
+            TemporarySlot<T> slot;
+            T* tmp = slot.Get();
+            Construct(alloc, tmp, std::forward<Args>(args)...);
+            VECTOR_TRY {
+                memory.Reallocate(new_capacity);
+            } VECTOR_CATCH_ALL {
+                Destroy(alloc, tmp);
+                VECTOR_RETHROW();
+            }
+            T* pos = memory.GetAddress() + offset;
+            RelocateN(pos, size - offset, pos + 1);
+            // Временный элемент не пересекается с буфером. memcpy одного элемента вместо RelocateN:
+            // GCC с -fsanitize=undefined не доказывает, что pos != nullptr, и выдаёт -Warray-bounds для memmove
+            std::memcpy(static_cast<void*>(pos), static_cast<const void*>(tmp), sizeof(T));
+            return true;
+        }
+        return false;
+    }
+
+    // Конструирует count элементов в позиции offset нового буфера new_first при помощи fill(T* gap)
+    // и переносит вокруг них элементы из first. При исключении исходные элементы остаются нетронутыми
+    template <typename Fill>
+    static VECTOR_CONSTEXPR void InsertRelocating(Allocator& alloc, T* first, size_t size, size_t offset, size_t count,
+                                                  T* new_first, Fill&& fill) {
+        T* gap = new_first + offset;
+        fill(gap);
+
+        if constexpr (CAN_RELOCATE) {
+            RelocateN(first, offset, new_first);
+            RelocateN(first + offset, size - offset, gap + count);
+        } else {
+            VECTOR_TRY {
+                UninitializedCopyOrMove(alloc, first, offset, new_first);
+            } VECTOR_CATCH_ALL {
+                DestroyN(alloc, gap, count);
+                VECTOR_RETHROW();
+            }
+
+            VECTOR_TRY {
+                UninitializedCopyOrMove(alloc, first + offset, size - offset, gap + count);
+            } VECTOR_CATCH_ALL {
+                DestroyN(alloc, new_first, offset + count);
+                VECTOR_RETHROW();
+            }
+
+            DestroyN(alloc, first, size);
+        }
+    }
+
+    // Конструирует элемент в позиции offset нового буфера new_first и переносит в него
+    // элементы из first. При исключении исходные элементы остаются нетронутыми
+    template <typename... Args>
+    static VECTOR_CONSTEXPR void EmplaceRelocating(Allocator& alloc, T* first, size_t size, size_t offset,
+                                                   T* new_first, Args&&... args) {
+        InsertRelocating(alloc, first, size, offset, 1, new_first, [&](T* gap) {
+            Construct(alloc, gap, std::forward<Args>(args)...);
+        });
+    }
+
+    // Сдвигает элементы [pos, last) на count позиций вправо в неинициализированную память,
+    // оставляя на месте [pos, pos + count) неинициализированный промежуток
+    static VECTOR_CONSTEXPR void OpenGap(Allocator& alloc, T* pos, T* last, size_t count) noexcept {
+        static_assert(CAN_SHIFT);
+        if constexpr (CAN_RELOCATE) {
+            RelocateN(pos, last - pos, pos + count);
+        } else {
+            for (T* it = last; it != pos;) {
+                --it;
+                Construct(alloc, it + count, std::move(*it));
+                Destroy(alloc, it);
+            }
+        }
+    }
+
+    // Закрывает промежуток, открытый OpenGap
+    static VECTOR_CONSTEXPR void CloseGap(Allocator& alloc, T* pos, T* last, size_t count) noexcept {
+        static_assert(CAN_SHIFT);
+        if constexpr (CAN_RELOCATE) {
+            RelocateN(pos + count, last - pos, pos);
+        } else {
+            for (T* it = pos; it != last; ++it) {
+                Construct(alloc, it, std::move(*(it + count)));
+                Destroy(alloc, it + count);
+            }
+        }
+    }
+
+    // Вставляет count элементов в позицию offset буфера, в котором для них есть место.
+    // Если fill выбрасывает исключение, элементы возвращаются на прежние места.
+    // Элементы, сдвиг которых нельзя откатить (!CAN_SHIFT), вставляются так только в конец
+    template <typename Fill>
+    static VECTOR_CONSTEXPR void InsertInPlace(Allocator& alloc, T* first, size_t size, size_t offset, size_t count,
+                                               Fill&& fill) {
+        T* pos = first + offset;
+        T* last = first + size;
+        if (pos == last) {
+            fill(pos);
+            return;
+        }
+        if constexpr (CAN_SHIFT) {
+            OpenGap(alloc, pos, last, count);
+            VECTOR_TRY {
+                fill(pos);
+            } VECTOR_CATCH_ALL {
+                CloseGap(alloc, pos, last, count);
+                VECTOR_RETHROW();
+            }
+        } else {
+            assert(false && "Elements that cannot be shifted back are inserted only at the end");
+        }
+    }
+
+    // Удаляет элемент в позиции offset, сдвигая следующие за ним элементы
+    static VECTOR_CONSTEXPR void Erase(Allocator& alloc, T* first, size_t size, size_t offset) noexcept(NOTHROW_ERASE) {
+        EraseRange(alloc, first, size, offset, 1);
+    }
+
+    // Удаляет count элементов, начиная с позиции offset, сдвигая следующие за ними элементы
+    static VECTOR_CONSTEXPR void EraseRange(Allocator& alloc, T* first, size_t size, size_t offset,
+                                            size_t count) noexcept(NOTHROW_ERASE) {
+        T* pos = first + offset;
+        T* last = first + size;
+        if constexpr (CAN_RELOCATE) {
+            DestroyN(alloc, pos, count);
+            RelocateN(pos + count, last - pos - count, pos);
+        } else {
+            std::move(pos + count, last, pos);
+            DestroyN(alloc, last - count, count);
+        }
+    }
+
+    // Удаляет элемент в позиции offset, перенося на его место последний элемент
+    static VECTOR_CONSTEXPR void UnorderedErase(Allocator& alloc, T* first, size_t size,
+                                                size_t offset) noexcept(NOTHROW_ERASE) {
+        T* pos = first + offset;
+        T* last = first + size - 1;
+        if (pos == last) {
+            Destroy(alloc, last);
+        } else if constexpr (CAN_RELOCATE) {
+            Destroy(alloc, pos);
+            RelocateN(last, 1, pos);
+        } else {
+            *pos = std::move(*last);
+            Destroy(alloc, last);
+        }
+    }
+
+    // Удаляет за один проход элементы, для которых pred возвращает true, сохраняя порядок остальных,
+    // и уменьшает size. Если pred выбрасывает исключение, уже отвергнутые им элементы удаляются,
+    // а непроверенные остаются на своих местах после оставленных
+    template <typename Pred>
+    static VECTOR_CONSTEXPR void RemoveIf(Allocator& alloc, T* first, size_t& size, Pred& pred) {
+        size_t kept = 0;
+        size_t i = 0;
+        VECTOR_TRY {
+            for (; i < size; ++i) {
+                if (pred(std::as_const(first[i]))) {
+                    if constexpr (CAN_RELOCATE) {
+                        Destroy(alloc, first + i);
+                    }
+                    continue;
+                }
+                if (kept != i) {
+                    if constexpr (CAN_RELOCATE) {
+                        RelocateN(first + i, 1, first + kept);
+                    } else {
+                        first[kept] = std::move(first[i]);
+                    }
+                }
+                ++kept;
+            }
+        } VECTOR_CATCH_ALL {
+            CloseRemovedGap(alloc, first, size, kept, i);
+            VECTOR_RETHROW();
+        }
+        CloseRemovedGap(alloc, first, size, kept, size);
+    }
+
+    // Переносит непроверенные элементы [checked, size) вплотную к оставленным [0, kept)
+    static VECTOR_CONSTEXPR void CloseRemovedGap(Allocator& alloc, T* first, size_t& size, size_t kept,
+                                                 size_t checked) {
+        const size_t unchecked = size - checked;
+        if constexpr (CAN_RELOCATE) {
+            RelocateN(first + checked, unchecked, first + kept);
+        } else {
+            std::move(first + checked, first + size, first + kept);
+            DestroyN(alloc, first + kept + unchecked, checked - kept);
+        }
+        size = kept + unchecked;
+    }
+};
+
+}  // namespace detail
+
+namespace detail {
+
+// Номер поколения буфера Vector при VECTOR_HARDENING_ITERATORS. Блоком совместно владеют вектор
+// и выданные им итераторы, поэтому итератор, переживший буфер и сам вектор, сверяет номер
+// с ещё не освобождённым блоком
+class GenerationBlock {
+public:
+    // Новый блок принадлежит создавшему его вектору
+    static GenerationBlock* Create() noexcept {
+        return new (std::nothrow) GenerationBlock();
+    }
+
+    static VECTOR_CONSTEXPR void AddRef(GenerationBlock* block) noexcept {
+        if (block != nullptr) {
+            block->refs_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    static VECTOR_CONSTEXPR void Release(GenerationBlock* block) noexcept {
+        if (block != nullptr && block->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete block;
+        }
+    }
+
+    size_t Get() const noexcept {
+        return generation_;
+    }
+
+    // Делает недействительными итераторы, выданные до вызова
+    void Advance() noexcept {
+        ++generation_;
+    }
+
+private:
+    size_t generation_ = 0;
+    std::atomic<size_t> refs_{1};
+};
+
+// Итератор Vector при VECTOR_HARDENING_ITERATORS: помимо указателя хранит номер поколения буфера
+// на момент создания и при обращении к элементу сверяет его с текущим номером буфера, который
+// увеличивается при каждой реаллокации, при разрушении всех элементов и при разрушении буфера
+template <typename T>
+class CheckedIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_cv_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    CheckedIterator() = default;
+
+    VECTOR_CONSTEXPR CheckedIterator(T* ptr, GenerationBlock* generation) noexcept
+        : ptr_(ptr)
+        , generation_(generation)
+        , expected_generation_(generation != nullptr ? generation->Get() : 0) {
+        GenerationBlock::AddRef(generation_);
+    }
+
+    VECTOR_CONSTEXPR CheckedIterator(const CheckedIterator& other) noexcept
+        : ptr_(other.ptr_)
+        , generation_(other.generation_)
+        , expected_generation_(other.expected_generation_) {
+        GenerationBlock::AddRef(generation_);
+    }
+
+    VECTOR_CONSTEXPR CheckedIterator(CheckedIterator&& other) noexcept
+        : ptr_(other.ptr_)
+        , generation_(std::exchange(other.generation_, nullptr))
+        , expected_generation_(other.expected_generation_) {
+    }
+
+    // iterator приводится к const_iterator
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T> && !std::is_same_v<U, T>>>
+    VECTOR_CONSTEXPR CheckedIterator(const CheckedIterator<U>& other) noexcept
+        : ptr_(other.ptr_)
+        , generation_(other.generation_)
+        , expected_generation_(other.expected_generation_) {
+        GenerationBlock::AddRef(generation_);
+    }
+
+    VECTOR_CONSTEXPR CheckedIterator& operator=(const CheckedIterator& rhs) noexcept {
+        GenerationBlock::AddRef(rhs.generation_);
+        GenerationBlock::Release(generation_);
+        ptr_ = rhs.ptr_;
+        generation_ = rhs.generation_;
+        expected_generation_ = rhs.expected_generation_;
+        return *this;
+    }
+
+    VECTOR_CONSTEXPR CheckedIterator& operator=(CheckedIterator&& rhs) noexcept {
+        if (this != &rhs) {
+            GenerationBlock::Release(generation_);
+            ptr_ = rhs.ptr_;
+            generation_ = std::exchange(rhs.generation_, nullptr);
+            expected_generation_ = rhs.expected_generation_;
+        }
+        return *this;
+    }
+
+    VECTOR_CONSTEXPR ~CheckedIterator() {
+        GenerationBlock::Release(generation_);
+    }
+
+    // Указатель на элемент; итератор должен быть действителен
+    VECTOR_CONSTEXPR T* Get() const noexcept {
+        VECTOR_HARDENING_ASSERT(generation_ == nullptr || generation_->Get() == expected_generation_);
+        return ptr_;
+    }
+
+    constexpr reference operator*() const noexcept {
+        return *Get();
+    }
+
+    constexpr pointer operator->() const noexcept {
+        return Get();
+    }
+
+    constexpr reference operator[](difference_type n) const noexcept {
+        return Get()[n];
+    }
+
+    constexpr CheckedIterator& operator++() noexcept {
+        ++ptr_;
+        return *this;
+    }
+
+    constexpr CheckedIterator operator++(int) noexcept {
+        CheckedIterator old = *this;
+        ++ptr_;
+        return old;
     }
 
-    RawMemory(const RawMemory&) = delete;
-    RawMemory& operator=(const RawMemory& rhs) = delete;
+    constexpr CheckedIterator& operator--() noexcept {
+        --ptr_;
+        return *this;
+    }
 
-    RawMemory(RawMemory&& other) noexcept {
-        capacity_ = std::exchange(other.capacity_, 0);
-        buffer_ = std::exchange(other.buffer_, nullptr);
+    constexpr CheckedIterator operator--(int) noexcept {
+        CheckedIterator old = *this;
+        --ptr_;
+        return old;
     }
 
-    RawMemory& operator=(RawMemory&& rhs) noexcept {
-        capacity_ = std::exchange(rhs.capacity_, 0);
-        buffer_ = std::exchange(rhs.buffer_, nullptr);
+    constexpr CheckedIterator& operator+=(difference_type n) noexcept {
+        ptr_ += n;
         return *this;
     }
 
-    ~RawMemory() {
-        Deallocate(buffer_);
+    constexpr CheckedIterator& operator-=(difference_type n) noexcept {
+        ptr_ -= n;
+        return *this;
     }
 
-    T* operator+(size_t offset) noexcept {
-        assert(offset <= capacity_);
-        return buffer_ + offset;
+    friend constexpr CheckedIterator operator+(CheckedIterator it, difference_type n) noexcept {
+        return it += n;
     }
 
-    const T* operator+(size_t offset) const noexcept {
-        return const_cast<RawMemory&>(*this) + offset;
+    friend constexpr CheckedIterator operator+(difference_type n, CheckedIterator it) noexcept {
+        return it += n;
     }
 
-    const T& operator[](size_t index) const noexcept {
-        return const_cast<RawMemory&>(*this)[index];
+    friend constexpr CheckedIterator operator-(CheckedIterator it, difference_type n) noexcept {
+        return it -= n;
     }
 
-    T& operator[](size_t index) noexcept {
-        assert(index < capacity_);
-        return buffer_[index];
+    friend constexpr difference_type operator-(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return lhs.Get() - rhs.Get();
     }
 
-    void Swap(RawMemory& other) noexcept {
-        std::swap(buffer_, other.buffer_);
-        std::swap(capacity_, other.capacity_);
+    friend constexpr bool operator==(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return lhs.ptr_ == rhs.ptr_;
     }
 
-    const T* GetAddress() const noexcept {
-        return buffer_;
+    friend constexpr bool operator!=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return lhs.ptr_ != rhs.ptr_;
     }
 
-    T* GetAddress() noexcept {
-        return buffer_;
+    friend constexpr bool operator<(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return lhs.ptr_ < rhs.ptr_;
     }
 
-    size_t Capacity() const {
-        return capacity_;
+    friend constexpr bool operator>(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return rhs < lhs;
+    }
+
+    friend constexpr bool operator<=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return !(rhs < lhs);
+    }
+
+    friend constexpr bool operator>=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return !(lhs < rhs);
     }
 
 private:
-    // Выделяет сырую память под n элементов и возвращает указатель на неё
-    static T* Allocate(size_t n) {
-        return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr;
+    template <typename U>
+    friend class CheckedIterator;
+
+    T* ptr_ = nullptr;
+    GenerationBlock* generation_ = nullptr;
+    size_t expected_generation_ = 0;
+};
+
+// Номер поколения буфера Vector. Без VECTOR_HARDENING_ITERATORS итераторы — указатели,
+// а класс пуст и не увеличивает размер вектора.
+// Блок с номером (GenerationBlock) создаётся при выдаче первого итератора и переходит к другому
+// вектору вместе с буфером при обмене и перемещении, поэтому итераторы остаются действительными
+// и ссылаются на элементы в новом владельце. Номер растёт при замене буфера, разрушении всех
+// элементов и разрушении вектора, владеющего буфером
+#if VECTOR_HARDENING_LEVEL >= VECTOR_HARDENING_ITERATORS
+class IteratorGeneration {
+public:
+    template <typename T>
+    using Iterator = CheckedIterator<T>;
+
+    constexpr IteratorGeneration() noexcept = default;
+
+    // Копия вектора начинает собственную последовательность поколений
+    constexpr IteratorGeneration(const IteratorGeneration& /*other*/) noexcept {
     }
 
-    // Освобождает сырую память, выделенную ранее по адресу buf при помощи Allocate
-    static void Deallocate(T* buf) noexcept {
-        operator delete(buf);
+    constexpr IteratorGeneration& operator=(const IteratorGeneration& /*rhs*/) noexcept {
+        return *this;
     }
 
-    T* buffer_ = nullptr;
-    size_t capacity_ = 0;
+    // Буфер разрушается вместе с вектором; блок освободит последний итератор
+    VECTOR_CONSTEXPR ~IteratorGeneration() {
+        if (!VECTOR_IS_CONSTANT_EVALUATED()) {
+            GenerationBlock* block = block_.load(std::memory_order_relaxed);
+            if (block != nullptr) {
+                block->Advance();
+            }
+            GenerationBlock::Release(block);
+        }
+    }
+
+    // Делает недействительными все выданные итераторы
+    VECTOR_CONSTEXPR void InvalidateIterators() noexcept {
+        if (!VECTOR_IS_CONSTANT_EVALUATED()) {
+            if (GenerationBlock* block = block_.load(std::memory_order_relaxed)) {
+                block->Advance();
+            }
+        }
+    }
+
+    // Обменивает блоки вместе с буферами векторов
+    VECTOR_CONSTEXPR void SwapIteratorGeneration(IteratorGeneration& other) noexcept {
+        if (!VECTOR_IS_CONSTANT_EVALUATED()) {
+            GenerationBlock* block = block_.load(std::memory_order_relaxed);
+            block_.store(other.block_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            other.block_.store(block, std::memory_order_relaxed);
+        }
+    }
+
+    template <typename T>
+    VECTOR_CONSTEXPR CheckedIterator<T> MakeIterator(T* ptr) const noexcept {
+        return {ptr, Block()};
+    }
+
+private:
+    // Итераторы константного вектора могут запрашиваться из разных потоков одновременно, поэтому
+    // блок публикуется атомарно. Если памяти под него нет, итераторы не проверяются
+    mutable std::atomic<GenerationBlock*> block_{nullptr};
+
+    VECTOR_CONSTEXPR GenerationBlock* Block() const noexcept {
+        if (VECTOR_IS_CONSTANT_EVALUATED()) {
+            return nullptr;
+        }
+        GenerationBlock* block = block_.load(std::memory_order_acquire);
+        if (block == nullptr) {
+            GenerationBlock* fresh = GenerationBlock::Create();
+            if (block_.compare_exchange_strong(block, fresh, std::memory_order_acq_rel)) {
+                block = fresh;
+            } else {
+                GenerationBlock::Release(fresh);
+            }
+        }
+        return block;
+    }
 };
+#else
+class IteratorGeneration {
+public:
+    template <typename T>
+    using Iterator = T*;
+
+    constexpr void InvalidateIterators() noexcept {
+    }
+
+    constexpr void SwapIteratorGeneration(IteratorGeneration& /*other*/) noexcept {
+    }
+
+    template <typename T>
+    static constexpr T* MakeIterator(T* ptr) noexcept {
+        return ptr;
+    }
+};
+#endif
+
+}  // namespace detail
+
+template <typename T, typename Allocator = std::allocator<T>, typename GrowthPolicy = DoublingGrowth,
+          typename Instrumentation = NoInstrumentation>
+class Vector : private detail::IteratorGeneration {
+    using AllocTraits = std::allocator_traits<Allocator>;
+    using Ops = detail::ElementOps<T, Allocator>;
+    using detail::IteratorGeneration::InvalidateIterators;
+    using detail::IteratorGeneration::MakeIterator;
+    using detail::IteratorGeneration::SwapIteratorGeneration;
 
-template <typename T>
-class Vector {
 public:
-    using iterator = T*;
-    using const_iterator = const T*;
+    using value_type = T;
+    using iterator = Iterator<T>;
+    using const_iterator = Iterator<const T>;
+    using allocator_type = Allocator;
 
     Vector() = default;
 
-    explicit Vector(size_t size)
-        : data_(size)
+    VECTOR_CONSTEXPR explicit Vector(const Allocator& alloc) noexcept
+        : data_(alloc) {
+    }
+
+    VECTOR_CONSTEXPR explicit Vector(size_t size, const Allocator& alloc = Allocator())
+        : data_(size, alloc)
         , size_(size)  //
     {
-        std::uninitialized_value_construct_n(data_.GetAddress(), size);
+        RecordAllocation(data_);
+        Ops::UninitializedValueConstructN(data_.GetAllocator(), data_.GetAddress(), size);
+        AnnotateNewBuffer();
     }
 
-    Vector(const Vector& other)
-        : data_(other.size_)
-        , size_(other.size_)  //
+    // Элементы не обнуляются, например, для буферов ввода-вывода, которые сразу же перезаписываются
+    VECTOR_CONSTEXPR Vector(size_t size, DefaultInitT, const Allocator& alloc = Allocator())
+        : data_(size, alloc)
+        , size_(size)  //
     {
-        // Конструируем элементы в data_, копируя их из other.data_
-        std::uninitialized_copy_n(other.data_.GetAddress(), other.size_, data_.GetAddress());
+        static_assert(IS_IMPLICIT_LIFETIME, "Default initialization is supported only for trivial types");
+        RecordAllocation(data_);
+        AnnotateNewBuffer();
     }
 
-    Vector(Vector&& other) noexcept {
-        size_ = std::exchange(other.size_, 0);
-        data_ = std::move(other.data_);
+    // Принимает во владение буфер с size сконструированными элементами, выделенный alloc
+    // (или равным ему аллокатором) под capacity элементов, например, полученный от Release
+    VECTOR_CONSTEXPR Vector(AdoptT, T* buffer, size_t size, size_t capacity,
+                            const Allocator& alloc = Allocator()) noexcept
+        : data_(adopt, buffer, capacity, alloc)
+        , size_(size)  //
+    {
+        assert(size <= capacity && (buffer != nullptr || capacity == 0));
+        AnnotateNewBuffer();
     }
 
-    Vector& operator=(const Vector& rhs) {
-        if (this != &rhs) {
-            if (rhs.size_ > data_.Capacity()) {
-                Vector rhs_copy(rhs);
-                Swap(rhs_copy);
-            } else {
+    // Параллельные версии конструкторов, Assign и Clear распределяют конструирование и разрушение
+    // элементов между потоками pool. Конструкторы и деструктор T, а также construct и destroy аллокатора
+    // должны допускать одновременный вызов из разных потоков для разных элементов. Требуют
+    // parallel_algorithms.h
+    template <typename Pool, typename = detail::RequireThreadPool<Pool>>
+    Vector(size_t size, Pool& pool, const Allocator& alloc = Allocator())
+        : data_(size, alloc)
+        , size_(size)  //
+    {
+        RecordAllocation(data_);
+        detail::ParallelElementOps<Pool>::ConstructN(
+            pool, data_.GetAllocator(), data_.GetAddress(), size,
+            [this](T* chunk_first, size_t /*chunk_offset*/, size_t chunk_size) {
+                Ops::UninitializedValueConstructN(data_.GetAllocator(), chunk_first, chunk_size);
+            });
+        AnnotateNewBuffer();
+    }
 
-                if (size_ > rhs.Size()) {
+    template <typename Pool, typename = detail::RequireThreadPool<Pool>>
+    Vector(const Vector& other, Pool& pool)
+        : Vector(other, pool, AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator())) {
+    }
 
-                    for (size_t i = 0; i < rhs.Size(); ++i) {
-                        data_[i] = rhs.data_[i];
-                    }
+    template <typename Pool, typename = detail::RequireThreadPool<Pool>>
+    Vector(const Vector& other, Pool& pool, const Allocator& alloc)
+        : data_(other.size_, alloc)
+        , size_(other.size_)  //
+    {
+        RecordAllocation(data_);
+        detail::ParallelElementOps<Pool>::ConstructN(
+            pool, data_.GetAllocator(), data_.GetAddress(), size_,
+            [this, &other](T* chunk_first, size_t chunk_offset, size_t chunk_size) {
+                Ops::UninitializedCopyN(data_.GetAllocator(), other.data_ + chunk_offset, chunk_size, chunk_first);
+            });
+        AnnotateNewBuffer();
+    }
 
-                    std::destroy_n(data_.GetAddress() + rhs.size_, size_ - rhs.size_);
-                    size_ = rhs.size_;
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    VECTOR_CONSTEXPR Vector(InputIt first, InputIt last, const Allocator& alloc = Allocator())
+        : data_(alloc) {
+        Assign(first, last);
+    }
 
-                } else {
+    VECTOR_CONSTEXPR Vector(const Vector& other)
+        : Vector(other, AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator())) {
+    }
 
-                    for (size_t i = 0; i < size_; ++i) {
-                        data_[i] = rhs.data_[i];
-                    }
+    VECTOR_CONSTEXPR Vector(const Vector& other, const Allocator& alloc)
+        : data_(other.size_, alloc)
+        , size_(other.size_)  //
+    {
+        RecordAllocation(data_);
+        // Конструируем элементы в data_, копируя их из other.data_
+        Ops::UninitializedCopyN(data_.GetAllocator(), other.data_.GetAddress(), other.size_, data_.GetAddress());
+        AnnotateNewBuffer();
+    }
 
-                    std::uninitialized_copy_n(rhs.data_.GetAddress() + size_, rhs.size_ - size_, data_.GetAddress() + size_);
-                    size_ = rhs.size_;
-                }
+    VECTOR_CONSTEXPR Vector(Vector&& other) noexcept
+        : data_(std::move(other.data_))
+        , size_(std::exchange(other.size_, 0))  //
+    {
+        // Итераторы other указывают на элементы, которые теперь принадлежат *this
+        SwapIteratorGeneration(other);
+    }
+
+    // Если аллокаторы не равны, буфер other не может перейти во владение *this,
+    // поэтому элементы перемещаются поштучно в новую память
+    VECTOR_CONSTEXPR Vector(Vector&& other, const Allocator& alloc)
+        : data_(alloc) {
+        if (alloc == other.data_.GetAllocator()) {
+            size_ = std::exchange(other.size_, 0);
+            data_ = std::move(other.data_);
+            SwapIteratorGeneration(other);
+        } else {
+            RawMemory<T, Allocator> new_data(other.size_, alloc);
+            RecordAllocation(new_data);
+            Ops::UninitializedMoveN(new_data.GetAllocator(), other.data_.GetAddress(), other.size_, new_data.GetAddress());
+            data_.Swap(new_data);
+            size_ = other.size_;
+            AnnotateNewBuffer();
+        }
+    }
 
+    VECTOR_CONSTEXPR Vector& operator=(const Vector& rhs) {
+        if (this != &rhs) {
+            if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+                if (data_.GetAllocator() != rhs.data_.GetAllocator()) {
+                    // Элементы и память должны быть освобождены прежним аллокатором
+                    AnnotateSlack(size_, Capacity());
+                    Ops::DestroyN(data_.GetAllocator(), data_.GetAddress(), size_);
+                    size_ = 0;
+                }
+                data_.AssignAllocator(rhs.data_.GetAllocator());
             }
+
+            // Память выделяется не более одного раза, а для тривиально копируемых типов
+            // элементы копируются одним memcpy либо memmove
+            Assign(rhs.data_.GetAddress(), rhs.data_ + rhs.size_);
         }
         return *this;
     }
 
-    Vector& operator=(Vector&& rhs) noexcept {
+    VECTOR_CONSTEXPR Vector& operator=(Vector&& rhs) noexcept(AllocTraits::propagate_on_container_move_assignment::value
+                                             || AllocTraits::is_always_equal::value) {
         if (this != &rhs) {
-            size_ = std::exchange(rhs.size_, 0);
-            data_ = std::move(rhs.data_);
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value
+                          || AllocTraits::is_always_equal::value) {
+                MoveAssignStorage(std::move(rhs));
+            } else if (data_.GetAllocator() == rhs.data_.GetAllocator()) {
+                MoveAssignStorage(std::move(rhs));
+            } else {
+                Vector rhs_moved(std::move(rhs), data_.GetAllocator());
+                Swap(rhs_moved);
+            }
         }
         return *this;
     }
 
-    void Swap(Vector& other) noexcept {
+    VECTOR_CONSTEXPR void Swap(Vector& other) noexcept {
+        if constexpr (!AllocTraits::propagate_on_container_swap::value) {
+            assert(data_.GetAllocator() == other.data_.GetAllocator());
+        }
         data_.Swap(other.data_);
         std::swap(size_, other.size_);
+        SwapIteratorGeneration(other);
+    }
+
+    VECTOR_CONSTEXPR allocator_type GetAllocator() const noexcept {
+        return data_.GetAllocator();
+    }
+
+    // Отдаёт буфер вместе с элементами, оставляя вектор пустым. Вызывающий код должен разрушить
+    // элементы и освободить память аллокатором GetAllocator() либо вернуть буфер в вектор (adopt)
+    [[nodiscard]] VECTOR_CONSTEXPR ReleasedBuffer<T> Release() noexcept {
+        InvalidateIterators();
+        AnnotateSlack(size_, Capacity());
+        const size_t size = std::exchange(size_, 0);
+        const AllocationResult<T> memory = data_.Release();
+        return {memory.ptr, size, memory.count};
     }
 
-    void Reserve(size_t new_capacity) {
+    VECTOR_CONSTEXPR void Reserve(size_t new_capacity) {
         if (new_capacity <= data_.Capacity()) {
             return;
         }
+        // Разметка не переносится reallocate и осталась бы на прежнем месте буфера, поэтому он
+        // открывается целиком. Если выделение памяти или перенос выбросят исключение, guard снова
+        // закроет [size_, Capacity())
+        SlackGuard guard(*this, Capacity());
 
-        RawMemory<T> new_data(new_capacity);
-        UninitializedCopyOrMove(begin(), size_, new_data.GetAddress());
-        std::destroy(begin(), end());
-        data_.Swap(new_data);
+        if (Ops::GrowInPlace(data_, new_capacity)) {
+            RecordReallocation(0);
+            return;
+        }
+
+        RawMemory<T, Allocator> new_data(new_capacity, data_.GetAllocator());
+        TransferTo(new_data);
+    }
+
+    // Как Reserve, но о нехватке памяти сообщает результатом false, оставляя вектор прежним.
+    // Исключения, выброшенные при копировании элементов, передаются вызывающему коду
+    [[nodiscard]] VECTOR_CONSTEXPR bool TryReserve(size_t new_capacity) noexcept(Ops::NOTHROW_TRANSFER) {
+        if (new_capacity <= data_.Capacity()) {
+            return true;
+        }
+        SlackGuard guard(*this);
+
+        if (data_.TryExpand(new_capacity)) {
+            RecordReallocation(0);
+            return true;
+        }
+
+        RawMemory<T, Allocator> new_data(data_.GetAllocator());
+        if (!new_data.TryAllocate(new_capacity)) {
+            return false;
+        }
+        TransferTo(new_data);
+        return true;
+    }
+
+    // Как Resize, но о нехватке памяти сообщает результатом false, оставляя вектор прежним
+    [[nodiscard]] VECTOR_CONSTEXPR bool TryResize(size_t new_size) {
+        if (!TryReserve(new_size)) {
+            return false;
+        }
+        Resize(new_size);
+        return true;
     }
 
-    void Resize(size_t new_size) {
+    VECTOR_CONSTEXPR void Resize(size_t new_size) {
         if (new_size < size_) {
-            std::destroy(cbegin() + new_size, cend());
+            {
+                SlackGuard guard(*this);
+                Ops::DestroyN(data_.GetAllocator(), data_ + new_size, size_ - new_size);
+                size_ = new_size;
+            }
+            ShrinkAfterErase();
 
         } else if (new_size > size_) {
             Reserve(new_size);
-            std::uninitialized_value_construct(begin() + size_, begin() + new_size);
+            SlackGuard guard(*this, new_size);
+            Ops::UninitializedValueConstructN(data_.GetAllocator(), data_ + size_, new_size - size_);
+            size_ = new_size;
+        }
+    }
+
+    // Освобождает неиспользуемую память, перенося элементы в буфер ёмкостью Size().
+    // Если перенос выбрасывает исключение, вектор остаётся прежним
+    VECTOR_CONSTEXPR void ShrinkToFit() {
+        if (size_ < Capacity()) {
+            SlackGuard guard(*this);
+            ShrinkTo(size_);
+        }
+    }
+
+    // Разрушает все элементы, сохраняя ёмкость. Автоматическое уменьшение ёмкости (ShrinkingGrowth)
+    // к Clear не применяется: очищенный вектор обычно заполняется снова
+    VECTOR_CONSTEXPR void Clear() noexcept {
+        SlackGuard guard(*this);
+        Ops::DestroyN(data_.GetAllocator(), data_.GetAddress(), size_);
+        size_ = 0;
+        InvalidateIterators();
+    }
+
+    // Разрушает элементы в потоках pool. Параллельного деструктора нет, поэтому большие векторы
+    // с нетривиально разрушаемыми элементами можно очистить так перед разрушением
+    template <typename Pool, typename = detail::RequireThreadPool<Pool>>
+    void Clear(Pool& pool) {
+        SlackGuard guard(*this);
+        detail::ParallelElementOps<Pool>::DestroyN(pool, data_.GetAllocator(), data_.GetAddress(), size_);
+        size_ = 0;
+        InvalidateIterators();
+    }
+
+    // Изменяет размер, не инициализируя новые элементы. Их значения не определены до первой записи
+    VECTOR_CONSTEXPR void Resize(size_t new_size, DefaultInitT) {
+        static_assert(IS_IMPLICIT_LIFETIME, "Default initialization is supported only for trivial types");
+        if (new_size < size_) {
+            {
+                SlackGuard guard(*this);
+                size_ = new_size;
+            }
+            ShrinkAfterErase();
+        } else {
+            Reserve(new_size);
+            SlackGuard guard(*this, new_size);
+            size_ = new_size;
+        }
+    }
+
+    VECTOR_CONSTEXPR void ResizeUninitialized(size_t new_size) {
+        Resize(new_size, default_init);
+    }
+
+    // Заменяет содержимое вектора элементами диапазона [first, last), выделяя память не более одного раза
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    VECTOR_CONSTEXPR void Assign(InputIt first, InputIt last) {
+        if constexpr (detail::IS_FORWARD_ITERATOR<InputIt>) {
+            const size_t count = std::distance(first, last);
+            SlackGuard guard(*this, count);
+            if (count > Capacity()) {
+                RawMemory<T, Allocator> new_data(count, data_.GetAllocator());
+                RecordAllocation(new_data);
+                Ops::UninitializedCopyN(data_.GetAllocator(), first, count, new_data.GetAddress());
+                Ops::DestroyN(data_.GetAllocator(), data_.GetAddress(), size_);
+                AnnotateSlack(size_, Capacity());
+                data_.Swap(new_data);
+                RecordReallocation(0);
+            } else {
+                Ops::AssignN(data_.GetAllocator(), first, count, data_.GetAddress(), size_);
+            }
+            size_ = count;
+        } else {
+            Clear();
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
         }
+    }
+
+    // Копия rhs строится в новом буфере, поэтому при исключении вектор остаётся прежним
+    template <typename Pool, typename = detail::RequireThreadPool<Pool>>
+    void Assign(const Vector& rhs, Pool& pool) {
+        if (this != &rhs) {
+            Vector rhs_copy(rhs, pool, data_.GetAllocator());
+            Swap(rhs_copy);
+            RecordReallocation(0);
+            rhs_copy.Clear(pool);
+        }
+    }
+
+    template <typename Range>
+    VECTOR_CONSTEXPR void Assign(const Range& range) {
+        Assign(std::begin(range), std::end(range));
+    }
+
+    VECTOR_CONSTEXPR void Assign(std::initializer_list<T> ilist) {
+        Assign(ilist.begin(), ilist.end());
+    }
+
+    // Добавляет элементы диапазона в конец вектора
+    template <typename Range>
+    VECTOR_CONSTEXPR void Append(const Range& range) {
+        Insert(cend(), std::begin(range), std::end(range));
+    }
 
-        size_ = new_size;
+    VECTOR_CONSTEXPR void Append(std::initializer_list<T> ilist) {
+        Insert(cend(), ilist.begin(), ilist.end());
     }
 
     template <typename... Args>
-    T& EmplaceBack(Args&&... args) {
+    VECTOR_CONSTEXPR T& EmplaceBack(Args&&... args) {
         return *Emplace(cend(), std::forward<Args>(args)...);
     }
 
-    void PushBack(const T& value) {
+    VECTOR_CONSTEXPR void PushBack(const T& value) {
         EmplaceBack(value);
     }
 
-    void PushBack(T&& value) {
+    VECTOR_CONSTEXPR void PushBack(T&& value) {
         EmplaceBack(std::move(value));
     }
 
-    void PopBack() /* noexcept */ {
-        assert(size_ != 0);
-        --size_;
-        std::destroy_at(end());
+    // Как EmplaceBack, но о нехватке памяти сообщает результатом false, оставляя вектор прежним.
+    // Исключения конструктора T передаются вызывающему коду
+    template <typename... Args>
+    [[nodiscard]] VECTOR_CONSTEXPR bool TryEmplaceBack(Args&&... args) {
+        SlackGuard guard(*this, size_ + 1);
+        if (size_ == Capacity()) {
+            const size_t new_capacity = GrowthPolicy::NextCapacity(Capacity(), size_ + 1, sizeof(T));
+            if (!data_.TryExpand(new_capacity)) {
+                RawMemory<T, Allocator> new_data(data_.GetAllocator());
+                if (!new_data.TryAllocate(new_capacity)) {
+                    return false;
+                }
+                EmplaceRelocating(new_data, size_, std::forward<Args>(args)...);
+                ++size_;
+                return true;
+            }
+            RecordReallocation(0);
+        }
+        Ops::Construct(data_.GetAllocator(), data_ + size_, std::forward<Args>(args)...);
+        ++size_;
+        return true;
+    }
+
+    VECTOR_CONSTEXPR void PopBack() noexcept {
+        VECTOR_HARDENING_ASSERT(size_ != 0);
+        {
+            SlackGuard guard(*this);
+            --size_;
+            Ops::Destroy(data_.GetAllocator(), data_ + size_);
+        }
+        ShrinkAfterErase();
+    }
+
+    VECTOR_CONSTEXPR iterator Erase(const_iterator pos) noexcept(Ops::NOTHROW_ERASE) {
+        VECTOR_HARDENING_ASSERT(begin() <= pos && pos < end() && size_ != 0);
+        size_t offset = pos - cbegin();
+        {
+            SlackGuard guard(*this);
+            Ops::Erase(data_.GetAllocator(), data_.GetAddress(), size_, offset);
+            --size_;
+        }
+        ShrinkAfterErase();
+
+        return begin() + offset;
+    }
+
+    VECTOR_CONSTEXPR iterator Erase(const_iterator first, const_iterator last) noexcept(Ops::NOTHROW_ERASE) {
+        VECTOR_HARDENING_ASSERT(begin() <= first && first <= last && last <= end());
+        size_t offset = first - cbegin();
+        size_t count = last - first;
+        if (count != 0) {
+            {
+                SlackGuard guard(*this);
+                Ops::EraseRange(data_.GetAllocator(), data_.GetAddress(), size_, offset, count);
+                size_ -= count;
+            }
+            ShrinkAfterErase();
+        }
+
+        return begin() + offset;
     }
 
-    iterator Erase(const_iterator pos) /*noexcept(std::is_nothrow_move_assignable_v<T>)*/ {
-        assert(begin() <= pos && pos < end() && size_ != 0);
-        iterator mutable_pos = begin() + (pos - cbegin());
-        std::move(mutable_pos + 1, end(), mutable_pos);
+    // Удаляет элемент за O(1), перенося на его место последний. Порядок элементов не сохраняется
+    VECTOR_CONSTEXPR iterator UnorderedErase(const_iterator pos) noexcept(Ops::NOTHROW_ERASE) {
+        VECTOR_HARDENING_ASSERT(begin() <= pos && pos < end());
+        const size_t offset = pos - cbegin();
+        {
+            SlackGuard guard(*this);
+            Ops::UnorderedErase(data_.GetAllocator(), data_.GetAddress(), size_, offset);
+            --size_;
+        }
+        ShrinkAfterErase();
+
+        return begin() + offset;
+    }
 
-        --size_;
-        std::destroy_at(end());
+    // Удаляет элементы с номерами из возрастающей последовательности sorted_indices за
+    // O(sorted_indices.size()): начиная с больших номеров, на место каждого удаляемого элемента
+    // переносится последний. Порядок элементов не сохраняется; если он важен, подойдёт EraseIf
+    template <typename IndexRange>
+    VECTOR_CONSTEXPR void EraseIndices(const IndexRange& sorted_indices) noexcept(Ops::NOTHROW_ERASE) {
+        auto it = std::end(sorted_indices);
+        const auto first = std::begin(sorted_indices);
+        if (it == first) {
+            return;
+        }
+        assert(std::is_sorted(first, it) && std::adjacent_find(first, it) == it);
+        assert(static_cast<size_t>(*std::prev(it)) < size_);
+        {
+            SlackGuard guard(*this);
+            do {
+                --it;
+                Ops::UnorderedErase(data_.GetAllocator(), data_.GetAddress(), size_, static_cast<size_t>(*it));
+                --size_;
+            } while (it != first);
+        }
+        ShrinkAfterErase();
+    }
 
-        return mutable_pos;
+    // Удаляет за один проход элементы, для которых pred возвращает true, и возвращает их число.
+    // Порядок оставшихся элементов сохраняется. Если pred выбрасывает исключение, уже отвергнутые
+    // им элементы удалены, остальные остаются в векторе
+    template <typename Pred>
+    VECTOR_CONSTEXPR size_t EraseIf(Pred pred) {
+        const size_t old_size = size_;
+        VECTOR_TRY {
+            SlackGuard guard(*this);
+            Ops::RemoveIf(data_.GetAllocator(), data_.GetAddress(), size_, pred);
+        } VECTOR_CATCH_ALL {
+            ShrinkAfterErase();
+            VECTOR_RETHROW();
+        }
+        if (size_ != old_size) {
+            ShrinkAfterErase();
+        }
+        return old_size - size_;
     }
 
     template <typename... Args>
-    iterator Emplace(const_iterator pos, Args&&... args) {
-        assert(begin() <= pos && pos <= end());
+    VECTOR_CONSTEXPR iterator Emplace(const_iterator pos, Args&&... args) {
+        VECTOR_HARDENING_ASSERT(begin() <= pos && pos <= end());
+        SlackGuard guard(*this, size_ + 1);
         size_t new_item_offset = std::distance(cbegin(), pos);
 
         if (size_ == Capacity()) {
-            EmplaceWithAllocation(pos, std::forward<Args>(args)...);
+            EmplaceWithAllocation(new_item_offset, std::forward<Args>(args)...);
         } else {
-            EmplaceWithoutAllocation(pos, std::forward<Args>(args)...);
+            Ops::EmplaceInPlace(data_.GetAllocator(), data_.GetAddress(), size_, new_item_offset, std::forward<Args>(args)...);
         }
 
         ++size_;
         return begin() + new_item_offset;
     }
 
-    iterator Insert(const_iterator pos, const T& value) {
+    VECTOR_CONSTEXPR iterator Insert(const_iterator pos, const T& value) {
         return Emplace(pos, value);
     }
 
-    iterator Insert(const_iterator pos, T&& value) {
+    VECTOR_CONSTEXPR iterator Insert(const_iterator pos, T&& value) {
         return Emplace(pos, std::move(value));
     }
 
-    size_t Size() const noexcept {
+    // Вставляет элементы диапазона [first, last), сдвигая хвост вектора один раз и выделяя память
+    // не более одного раза. Итераторы не должны указывать на элементы самого вектора
+    template <typename InputIt, typename = detail::RequireInputIterator<InputIt>>
+    VECTOR_CONSTEXPR iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+        VECTOR_HARDENING_ASSERT(begin() <= pos && pos <= end());
+        size_t offset = pos - cbegin();
+
+        if constexpr (detail::IS_FORWARD_ITERATOR<InputIt>) {
+            const size_t count = std::distance(first, last);
+            InsertWith(offset, count, [this, first, count](T* gap) {
+                Ops::UninitializedCopyN(data_.GetAllocator(), first, count, gap);
+            });
+        } else {
+            // Длина однопроходного диапазона неизвестна, поэтому элементы добавляются в конец
+            // и затем переставляются на место
+            const size_t old_size = size_;
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+            std::rotate(begin() + offset, begin() + old_size, end());
+        }
+
+        return begin() + offset;
+    }
+
+    VECTOR_CONSTEXPR iterator Insert(const_iterator pos, size_t count, const T& value) {
+        VECTOR_HARDENING_ASSERT(begin() <= pos && pos <= end());
+        if (Contains(&value)) {
+            // value будет сдвинут вместе с хвостом вектора, поэтому вставляется его копия
+            const T value_copy(value);
+            return Insert(pos, count, value_copy);
+        }
+
+        size_t offset = pos - cbegin();
+        InsertWith(offset, count, [this, &value, count](T* gap) {
+            Ops::UninitializedFillN(data_.GetAllocator(), gap, count, value);
+        });
+
+        return begin() + offset;
+    }
+
+    VECTOR_CONSTEXPR iterator Insert(const_iterator pos, std::initializer_list<T> ilist) {
+        return Insert(pos, ilist.begin(), ilist.end());
+    }
+
+    VECTOR_CONSTEXPR size_t Size() const noexcept {
         return size_;
     }
 
-    size_t Capacity() const noexcept {
+    VECTOR_CONSTEXPR size_t Capacity() const noexcept {
         return data_.Capacity();
     }
 
-    const T& operator[](size_t index) const noexcept {
+    // Проверяет индекс при любом уровне VECTOR_HARDENING_LEVEL
+    VECTOR_CONSTEXPR const T& At(size_t index) const {
+        return const_cast<Vector&>(*this).At(index);
+    }
+
+    VECTOR_CONSTEXPR T& At(size_t index) {
+        if (index >= size_) {
+            VECTOR_THROW(std::out_of_range("Vector index out of range"));
+        }
+        return data_[index];
+    }
+
+    VECTOR_CONSTEXPR const T& operator[](size_t index) const noexcept {
         return const_cast<Vector&>(*this)[index];
     }
 
-    T& operator[](size_t index) noexcept {
-        assert(index < size_);
+    VECTOR_CONSTEXPR T& operator[](size_t index) noexcept {
+        VECTOR_HARDENING_ASSERT(index < size_);
         return data_[index];
     }
 
-    ~Vector() {
-        std::destroy(begin(), end());
+    VECTOR_CONSTEXPR ~Vector() {
+        Ops::DestroyN(data_.GetAllocator(), data_.GetAddress(), size_);
+        AnnotateSlack(size_, Capacity());
     }
 
-    iterator begin() noexcept {
-        return data_.GetAddress();
+    VECTOR_CONSTEXPR iterator begin() noexcept {
+        return MakeIterator(data_.GetAddress());
     }
 
-    iterator end() noexcept {
-        return data_.GetAddress() + size_;
+    VECTOR_CONSTEXPR iterator end() noexcept {
+        return MakeIterator(data_ + size_);
     }
 
-    const_iterator begin() const noexcept {
+    VECTOR_CONSTEXPR const_iterator begin() const noexcept {
         return cbegin();
     }
 
-    const_iterator end() const noexcept {
+    VECTOR_CONSTEXPR const_iterator end() const noexcept {
         return cend();
     }
 
-    const_iterator cbegin() const noexcept {
+    VECTOR_CONSTEXPR const_iterator cbegin() const noexcept {
+        return MakeIterator(data_.GetAddress());
+    }
+
+    VECTOR_CONSTEXPR const_iterator cend() const noexcept {
+        return MakeIterator(data_ + size_);
+    }
+
+    // Указатель на первый элемент, в отличие от begin() — всегда обычный указатель
+    VECTOR_CONSTEXPR T* Data() noexcept {
         return data_.GetAddress();
     }
 
-    const_iterator cend() const noexcept {
-        return data_.GetAddress() + size_;
+    VECTOR_CONSTEXPR const T* Data() const noexcept {
+        return data_.GetAddress();
     }
 
 private:
-    RawMemory<T> data_;
+    // Объекты таких типов начинают существовать без вызова конструктора и не требуют разрушения,
+    // поэтому память под них можно не инициализировать
+    static constexpr bool IS_IMPLICIT_LIFETIME
+        = std::is_trivially_default_constructible_v<T> && std::is_trivially_destructible_v<T>;
+
+    RawMemory<T, Allocator> data_;
     size_t size_ = 0;
 
-    template <typename InputIt, typename OutputIt>
-    void UninitializedCopyOrMove(InputIt first, size_t number_elements, OutputIt d_first) {
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(first, number_elements, d_first);
+    // Указывает ли p на элемент вектора. На этапе компиляции указатели на разные объекты нельзя
+    // сравнивать на больше-меньше, поэтому там p сравнивается на равенство с каждым элементом
+    VECTOR_CONSTEXPR bool Contains(const T* p) const noexcept {
+        if (VECTOR_IS_CONSTANT_EVALUATED()) {
+            for (const T& item : *this) {
+                if (&item == p) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        return data_.GetAddress() <= p && p < data_ + size_;
+    }
+
+    static VECTOR_CONSTEXPR void RecordAllocation(const RawMemory<T, Allocator>& memory) noexcept {
+        if (memory.Capacity() != 0) {
+            Instrumentation::OnAllocate(memory.Capacity() * sizeof(T));
+            Instrumentation::OnCapacity(memory.Capacity());
+        }
+    }
+
+    // Вызывается после замены или изменения на месте буфера, в новый буфер перенесено transferred элементов
+    VECTOR_CONSTEXPR void RecordReallocation(size_t transferred) noexcept {
+        InvalidateIterators();
+        Instrumentation::OnReallocate();
+        if constexpr (Ops::TRANSFER_COPIES) {
+            Instrumentation::OnTransfer(0, transferred);
         } else {
-            std::uninitialized_copy_n(first, number_elements, d_first);
+            Instrumentation::OnTransfer(transferred, 0);
         }
+        Instrumentation::OnCapacity(Capacity());
     }
 
-    template <typename... Args>
-    void EmplaceWithoutAllocation(const_iterator pos, Args&&... args) {
-        if (pos == end()) {
-            new (end()) T(std::forward<Args>(args)...);
+    // Смещает границу размеченной части буфера с old_mid на new_mid элементов
+    // (см. VECTOR_ANNOTATE_CONTAINERS). Перед тем как буфер освобождается или отдаётся,
+    // он становится доступным целиком: AnnotateSlack(size_, Capacity())
+    VECTOR_CONSTEXPR void AnnotateSlack(size_t old_mid, size_t new_mid) const noexcept {
+#if VECTOR_ANNOTATE_CONTAINERS
+        if (!VECTOR_IS_CONSTANT_EVALUATED() && old_mid != new_mid && Capacity() != 0) {
+            detail::AnnotateContiguousContainer(data_.GetAddress(), data_ + Capacity(), data_ + old_mid,
+                                                data_ + new_mid);
+        }
+#else
+        static_cast<void>(old_mid);
+        static_cast<void>(new_mid);
+#endif
+    }
+
+    // Размечает буфер, только что полученный вектором: всё после size_ недоступно
+    VECTOR_CONSTEXPR void AnnotateNewBuffer() const noexcept {
+        AnnotateSlack(Capacity(), size_);
+    }
+
+#if VECTOR_ANNOTATE_CONTAINERS
+    // Разметка на время изменяющей операции. Конструктор открывает участок [size_, required_size),
+    // который операция заполнит, деструктор закрывает всё, что оказалось после нового size_.
+    // Стоимость пропорциональна изменению размера, а после замены буфера — его ёмкости
+    class SlackGuard {
+    public:
+        VECTOR_CONSTEXPR explicit SlackGuard(Vector& vector, size_t required_size = 0) noexcept
+            : vector_(vector)
+            , buffer_(vector.data_.GetAddress())
+            , capacity_(vector.Capacity())
+            , mid_(std::max(vector.size_, std::min(required_size, capacity_))) {
+            vector_.AnnotateSlack(vector_.size_, mid_);
+        }
+
+        SlackGuard(const SlackGuard&) = delete;
+        SlackGuard& operator=(const SlackGuard&) = delete;
+
+        VECTOR_CONSTEXPR ~SlackGuard() {
+            if (vector_.data_.GetAddress() != buffer_) {
+                // Прежний буфер стал доступным перед заменой, новый ещё не размечен
+                vector_.AnnotateNewBuffer();
+            } else if (vector_.Capacity() != capacity_) {
+                // Буфер увеличен на месте: к прежней разметке добавилась неразмеченная память
+                if (!VECTOR_IS_CONSTANT_EVALUATED() && capacity_ != 0) {
+                    detail::AnnotateContiguousContainer(buffer_, buffer_ + capacity_, buffer_ + mid_,
+                                                        buffer_ + capacity_);
+                }
+                vector_.AnnotateNewBuffer();
+            } else {
+                vector_.AnnotateSlack(mid_, vector_.size_);
+            }
+        }
+
+    private:
+        Vector& vector_;
+        const T* buffer_;
+        size_t capacity_;
+        size_t mid_;
+    };
+#else
+    class SlackGuard {
+    public:
+        constexpr explicit SlackGuard(Vector& /*vector*/, size_t /*required_size*/ = 0) noexcept {
+        }
+    };
+#endif
+
+    // Переносит элементы в буфер ёмкостью new_capacity >= size_
+    VECTOR_CONSTEXPR void ShrinkTo(size_t new_capacity) {
+        if (new_capacity == 0) {
+            RawMemory<T, Allocator> empty(data_.GetAllocator());
+            AnnotateSlack(size_, Capacity());
+            data_.Swap(empty);
+            RecordReallocation(0);
+            return;
+        }
 
+        if constexpr (Ops::CAN_REALLOCATE) {
+            AnnotateSlack(size_, Capacity());
+            VECTOR_TRY {
+                data_.Reallocate(new_capacity);
+            } VECTOR_CATCH_ALL {
+                // Буфер и ёмкость не изменились, неиспользуемая часть снова закрывается
+                AnnotateSlack(Capacity(), size_);
+                VECTOR_RETHROW();
+            }
+            RecordReallocation(0);
         } else {
-            new (end()) T(std::forward<T>(*(end() - 1)));
-            iterator mutable_pos = begin() + (pos - cbegin());
+            RawMemory<T, Allocator> new_data(new_capacity, data_.GetAllocator());
+            TransferTo(new_data);
+        }
+    }
 
-            RawMemory<T> tmp(1);
-            new (tmp.GetAddress()) T(std::forward<Args>(args)...);
+    // Переносит элементы в только что выделенный буфер new_data и делает его текущим
+    VECTOR_CONSTEXPR void TransferTo(RawMemory<T, Allocator>& new_data) noexcept(Ops::NOTHROW_TRANSFER) {
+        RecordAllocation(new_data);
+        Ops::TransferN(data_.GetAllocator(), data_.GetAddress(), size_, new_data.GetAddress());
+        AnnotateSlack(size_, Capacity());
+        data_.Swap(new_data);
+        RecordReallocation(size_);
+    }
 
-            std::move_backward(mutable_pos, end() - 1, end());
-            *mutable_pos = std::move(*tmp.GetAddress());
-            std::destroy_at(tmp.GetAddress());
+    // Уменьшает ёмкость после удаления элементов, если этого требует стратегия роста.
+    // Уменьшение необязательно, поэтому ошибки выделения памяти и переноса элементов игнорируются.
+    // Вызывается вне SlackGuard удаления, когда разметка уже закрыта по size_
+    VECTOR_CONSTEXPR void ShrinkAfterErase() noexcept {
+        if constexpr (detail::HasShrinkCapacity<GrowthPolicy>::value) {
+            const size_t new_capacity = GrowthPolicy::ShrinkCapacity(Capacity(), size_, sizeof(T));
+            if (new_capacity < Capacity()) {
+                SlackGuard guard(*this);
+                VECTOR_TRY {
+                    ShrinkTo(new_capacity);
+                } VECTOR_CATCH_ALL {
+                    // Элементы остались в прежнем буфере
+                }
+            }
         }
     }
 
-    template <typename... Args>
-    void EmplaceWithAllocation(const_iterator pos, Args&&... args) {
-        size_t new_item_offset = pos - cbegin();
+    // Вызывается, когда буфер rhs может перейти во владение *this
+    VECTOR_CONSTEXPR void MoveAssignStorage(Vector&& rhs) noexcept {
+        // Прежний буфер освобождается, а счётчик rhs переходит к *this вместе с буфером rhs
+        InvalidateIterators();
+        AnnotateSlack(size_, Capacity());
+        Ops::DestroyN(data_.GetAllocator(), data_.GetAddress(), size_);
+        size_ = std::exchange(rhs.size_, 0);
+        data_ = std::move(rhs.data_);
+        SwapIteratorGeneration(rhs);
+    }
 
-        RawMemory<T> new_data((size_ == 0) ? 1 : size_ * 2);
-        iterator new_items_pos = new_data.GetAddress() + new_item_offset;
-        new (new_items_pos) T(std::forward<Args>(args)...);
+    template <typename... Args>
+    VECTOR_CONSTEXPR void EmplaceWithAllocation(size_t new_item_offset, Args&&... args) {
+        size_t new_capacity = GrowthPolicy::NextCapacity(Capacity(), size_ + 1, sizeof(T));
 
-        try {
-            UninitializedCopyOrMove(begin(), new_item_offset, new_data.GetAddress());
-        } catch (...) {
-            std::destroy_at(new_items_pos);
-            throw;
+        if (Ops::EmplaceGrowingInPlace(data_, size_, new_item_offset, new_capacity, std::forward<Args>(args)...)) {
+            RecordReallocation(0);
+            return;
         }
 
-        try {
-            UninitializedCopyOrMove(begin() + new_item_offset, size_ - new_item_offset,
-                                    new_data.GetAddress() + new_item_offset + 1);
-        } catch (...) {
-            std::destroy_n(new_data.GetAddress(), new_item_offset);
-            throw;
-        }
+        RawMemory<T, Allocator> new_data(new_capacity, data_.GetAllocator());
+        EmplaceRelocating(new_data, new_item_offset, std::forward<Args>(args)...);
+    }
 
-        std::destroy(begin(), end());
+    // Конструирует новый элемент в буфере new_data, переносит в него остальные и делает его текущим
+    template <typename... Args>
+    VECTOR_CONSTEXPR void EmplaceRelocating(RawMemory<T, Allocator>& new_data, size_t new_item_offset, Args&&... args) {
+        RecordAllocation(new_data);
+        Ops::EmplaceRelocating(data_.GetAllocator(), data_.GetAddress(), size_, new_item_offset, new_data.GetAddress(),
+                               std::forward<Args>(args)...);
+        AnnotateSlack(size_, Capacity());
         data_.Swap(new_data);
+        RecordReallocation(size_);
+    }
+
+    // Вставляет count элементов в позицию offset, конструируя их при помощи fill(T* gap)
+    template <typename Fill>
+    VECTOR_CONSTEXPR void InsertWith(size_t offset, size_t count, Fill&& fill) {
+        if (count == 0) {
+            return;
+        }
+
+        SlackGuard guard(*this, size_ + count);
+        if (size_ + count <= Capacity() && (Ops::CAN_SHIFT || offset == size_)) {
+            Ops::InsertInPlace(data_.GetAllocator(), data_.GetAddress(), size_, offset, count, fill);
+        } else {
+            // Если сдвиг элементов нельзя откатить, вставка выполняется в новый буфер
+            const size_t new_capacity = size_ + count <= Capacity()
+                ? Capacity()
+                : GrowthPolicy::NextCapacity(Capacity(), size_ + count, sizeof(T));
+            RawMemory<T, Allocator> new_data(new_capacity, data_.GetAllocator());
+            RecordAllocation(new_data);
+            Ops::InsertRelocating(data_.GetAllocator(), data_.GetAddress(), size_, offset, count, new_data.GetAddress(), fill);
+            AnnotateSlack(size_, Capacity());
+            data_.Swap(new_data);
+            RecordReallocation(size_);
+        }
+        size_ += count;
     }
 };
+
+namespace pmr {
+
+// Вектор, память для которого предоставляет std::pmr::memory_resource,
+// например, std::pmr::monotonic_buffer_resource на время обработки запроса
+template <typename T, typename GrowthPolicy = DoublingGrowth>
+using Vector = ::Vector<T, std::pmr::polymorphic_allocator<T>, GrowthPolicy>;
+
+}  // namespace pmr
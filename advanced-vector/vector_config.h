@@ -0,0 +1,176 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <type_traits>
+
+// Сборка без исключений (-fno-exceptions). Блоки отката при исключениях записываются как
+//   VECTOR_TRY { ... } VECTOR_CATCH_ALL { откат; VECTOR_RETHROW(); }
+// и без исключений компилируются в недостижимую ветку. Ошибки, о которых нельзя сообщить
+// исключением (VECTOR_THROW), завершают программу; сообщить о нехватке памяти без исключений
+// позволяют TryReserve, TryEmplaceBack и TryResize. Заголовки mapped_vector.h и vector_io.h
+// сообщают об ошибках ОС исключениями и требуют сборки с ними
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS)
+#define VECTOR_HAS_EXCEPTIONS 1
+#else
+#define VECTOR_HAS_EXCEPTIONS 0
+#endif
+
+#if VECTOR_HAS_EXCEPTIONS
+#define VECTOR_TRY try
+#define VECTOR_CATCH_ALL catch (...)
+#define VECTOR_RETHROW() throw
+#define VECTOR_THROW(exception) throw exception
+#else
+#define VECTOR_TRY if (true)
+#define VECTOR_CATCH_ALL else
+#define VECTOR_RETHROW() static_cast<void>(0)
+#define VECTOR_THROW(exception) std::abort()
+#endif
+
+// Vector и RawMemory можно использовать при вычислениях на этапе компиляции, если стандартная
+// библиотека поддерживает constexpr std::allocator (C++20). Иначе VECTOR_CONSTEXPR пуст
+#if defined(__cpp_lib_constexpr_dynamic_alloc) && __cpp_lib_constexpr_dynamic_alloc >= 201907L
+#define VECTOR_HAS_CONSTEXPR 1
+#define VECTOR_CONSTEXPR constexpr
+#define VECTOR_IS_CONSTANT_EVALUATED() std::is_constant_evaluated()
+#else
+#define VECTOR_HAS_CONSTEXPR 0
+#define VECTOR_CONSTEXPR
+#define VECTOR_IS_CONSTANT_EVALUATED() false
+#endif
+
+// Уровень проверок контейнеров. Задаётся для всей программы до включения заголовков,
+// например -DVECTOR_HARDENING_LEVEL=1:
+//   VECTOR_HARDENING_NONE — только assert, в release-сборке проверок нет (по умолчанию);
+//   VECTOR_HARDENING_BOUNDS — индексы operator[] и позиции Insert, Erase и PopBack
+//     проверяются в любой сборке;
+//   VECTOR_HARDENING_ITERATORS — кроме того, итераторы Vector хранят номер поколения буфера
+//     и обнаруживают обращение к элементам после реаллокации. Итераторы и Vector становятся больше.
+// Нарушенная проверка завершает программу. At проверяет индекс при любом уровне
+#define VECTOR_HARDENING_NONE 0
+#define VECTOR_HARDENING_BOUNDS 1
+#define VECTOR_HARDENING_ITERATORS 2
+
+#ifndef VECTOR_HARDENING_LEVEL
+#define VECTOR_HARDENING_LEVEL VECTOR_HARDENING_NONE
+#endif
+
+namespace detail {
+
+[[noreturn]] inline void HardeningFailure(const char* condition, const char* file, int line) noexcept {
+    std::fprintf(stderr, "%s:%d: Vector hardening check failed: %s\n", file, line, condition);
+    std::abort();
+}
+
+}  // namespace detail
+
+#if defined(__GNUC__) || defined(__clang__)
+#define VECTOR_LIKELY(condition) __builtin_expect(!!(condition), 1)
+#else
+#define VECTOR_LIKELY(condition) (!!(condition))
+#endif
+
+#if VECTOR_HARDENING_LEVEL >= VECTOR_HARDENING_BOUNDS
+#define VECTOR_HARDENING_ASSERT(condition) \
+    (VECTOR_LIKELY(condition) ? static_cast<void>(0) : ::detail::HardeningFailure(#condition, __FILE__, __LINE__))
+#else
+#define VECTOR_HARDENING_ASSERT(condition) assert(condition)
+#endif
+
+// Разметка неиспользуемой части буфера Vector (от Size() до Capacity()) для инструментов поиска
+// ошибок памяти: ASan сообщает об обращении к ней как о container-overflow, MSan считает её
+// неинициализированной, а Valgrind (при -DVECTOR_VALGRIND=1) — недоступной. В сборках с ASan и MSan
+// разметка включается сама, -DVECTOR_ANNOTATE_CONTAINERS=0 отключает её. Все единицы трансляции
+// программы должны собираться с одним значением. Без разметки её вызовы не компилируются вовсе
+#if defined(__SANITIZE_ADDRESS__)
+#define VECTOR_HAS_ASAN 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define VECTOR_HAS_ASAN 1
+#endif
+#endif
+#ifndef VECTOR_HAS_ASAN
+#define VECTOR_HAS_ASAN 0
+#endif
+
+#if defined(__has_feature)
+#if __has_feature(memory_sanitizer)
+#define VECTOR_HAS_MSAN 1
+#endif
+#endif
+#ifndef VECTOR_HAS_MSAN
+#define VECTOR_HAS_MSAN 0
+#endif
+
+#ifndef VECTOR_VALGRIND
+#define VECTOR_VALGRIND 0
+#endif
+
+#ifndef VECTOR_ANNOTATE_CONTAINERS
+#if VECTOR_HAS_ASAN || VECTOR_HAS_MSAN || VECTOR_VALGRIND
+#define VECTOR_ANNOTATE_CONTAINERS 1
+#else
+#define VECTOR_ANNOTATE_CONTAINERS 0
+#endif
+#endif
+
+#if VECTOR_ANNOTATE_CONTAINERS
+#if VECTOR_HAS_ASAN
+#include <sanitizer/common_interface_defs.h>
+#endif
+#if VECTOR_HAS_MSAN
+#include <sanitizer/msan_interface.h>
+#endif
+#if VECTOR_VALGRIND
+#include <valgrind/memcheck.h>
+#endif
+
+namespace detail {
+
+// Граница между доступной и недоступной частями буфера [first, last) сместилась с old_mid на new_mid
+inline void AnnotateContiguousContainer(const void* first, const void* last, const void* old_mid,
+                                        const void* new_mid) noexcept {
+#if VECTOR_HAS_ASAN
+    // ASan требует выровненного по грануле начала. Неполная последняя гранула не размечается:
+    // её остаток может принадлежать соседнему объекту
+    constexpr std::uintptr_t GRANULE = 8;
+    const auto begin = reinterpret_cast<std::uintptr_t>(first);
+    const auto end = reinterpret_cast<std::uintptr_t>(last) & ~(GRANULE - 1);
+    if (begin % GRANULE == 0 && begin < end) {
+        __sanitizer_annotate_contiguous_container(
+            first, reinterpret_cast<const void*>(end),
+            reinterpret_cast<const void*>(std::min(reinterpret_cast<std::uintptr_t>(old_mid), end)),
+            reinterpret_cast<const void*>(std::min(reinterpret_cast<std::uintptr_t>(new_mid), end)));
+    }
+#else
+    static_cast<void>(first);
+    static_cast<void>(last);
+#endif
+#if VECTOR_HAS_MSAN || VECTOR_VALGRIND
+    auto* old_byte = static_cast<char*>(const_cast<void*>(old_mid));
+    auto* new_byte = static_cast<char*>(const_cast<void*>(new_mid));
+#else
+    static_cast<void>(old_mid);
+    static_cast<void>(new_mid);
+#endif
+#if VECTOR_HAS_MSAN
+    if (new_byte < old_byte) {
+        __msan_poison(new_byte, old_byte - new_byte);
+    }
+#endif
+#if VECTOR_VALGRIND
+    if (new_byte < old_byte) {
+        VALGRIND_MAKE_MEM_NOACCESS(new_byte, old_byte - new_byte);
+    } else if (old_byte < new_byte) {
+        VALGRIND_MAKE_MEM_UNDEFINED(old_byte, new_byte - old_byte);
+    }
+#endif
+}
+
+}  // namespace detail
+#endif
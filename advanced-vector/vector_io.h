@@ -0,0 +1,69 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <system_error>
+#include <type_traits>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "span.h"
+#include "vector.h"
+
+// Экспорт буферов векторов в виде iovec для writev/readv и io_uring без копирования данных.
+// iovec ссылается на элементы вектора и действителен до первой реаллокации
+
+template <typename T>
+iovec ToIovec(Span<T> span) noexcept {
+    static_assert(std::is_trivially_copyable_v<std::remove_cv_t<T>>, "Elements are transferred as bytes");
+    // Для writev буфер только читается, поэтому константность можно снять
+    return {const_cast<void*>(static_cast<const void*>(span.Data())), span.SizeBytes()};
+}
+
+// Собирает iovec для нескольких буферов: MakeIovecs(header, body) для writev
+template <typename... Buffers>
+std::array<iovec, sizeof...(Buffers)> MakeIovecs(Buffers&... buffers) noexcept {
+    return {ToIovec(Span(buffers))...};
+}
+
+// Добавляет в out по одному iovec на каждый буфер диапазона buffers
+template <typename Range>
+void AppendIovecs(Vector<iovec>& out, Range& buffers) {
+    for (auto& buffer : buffers) {
+        out.PushBack(ToIovec(Span(buffer)));
+    }
+}
+
+// Записывает все буферы, повторяя writev после частичной записи и прерывания сигналом.
+// Бросает std::system_error при ошибке, в том числе с EIO, если writev вернул 0, не записав
+// оставшиеся данные. Элементы iovecs изменяются по мере записи
+inline void WriteAll(int fd, Span<iovec> iovecs) {
+    while (!iovecs.Empty()) {
+        const int count = static_cast<int>(std::min<size_t>(iovecs.Size(), IOV_MAX));
+        const ssize_t written = writev(fd, iovecs.Data(), count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "writev failed");
+        }
+
+        const size_t size_before = iovecs.Size();
+        size_t remaining = static_cast<size_t>(written);
+        while (!iovecs.Empty() && remaining >= iovecs[0].iov_len) {
+            remaining -= iovecs[0].iov_len;
+            iovecs = iovecs.Last(iovecs.Size() - 1);
+        }
+        if (remaining != 0) {
+            iovecs[0].iov_base = static_cast<char*>(iovecs[0].iov_base) + remaining;
+            iovecs[0].iov_len -= remaining;
+        }
+        // writev не записал ни байта, хотя данные остались: повтор ничего не изменит
+        if (written == 0 && iovecs.Size() == size_before) {
+            throw std::system_error(EIO, std::generic_category(), "writev made no progress");
+        }
+    }
+}